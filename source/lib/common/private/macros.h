@@ -30,12 +30,12 @@
 STATIC_INLINE uint16_t clamp_uint(int32_t value, uint32_t precision)
 {
     const int32_t limit = ((1 << precision) - 1);
-    
-    if (value < 0)
-        value = 0;
-    else if (value > limit)
-        value = limit;
-    
+
+    // The comparisons are written as conditional expressions so that the
+    // compiler emits conditional moves instead of unpredictable branches
+    value = (value < 0) ? 0 : value;
+    value = (value > limit) ? limit : value;
+
     return (uint16_t)value;
 }
 
@@ -74,11 +74,30 @@ STATIC_INLINE int absolute(int a)
     return (a < 0) ? -a : a;
 }
 
+STATIC_INLINE uint16_t Swap16(uint16_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    // Compiles to a single rolw (or rev16 on ARM) instruction
+    return __builtin_bswap16(value);
+#elif defined(_MSC_VER)
+    return _byteswap_ushort(value);
+#else
+    return (uint16_t)((value << 8) | (value >> 8));
+#endif
+}
+
 STATIC_INLINE uint32_t Swap32(uint32_t value)
 {
+#if defined(__GNUC__) || defined(__clang__)
+    // Compiles to a single bswap (or rev on ARM) instruction
+    return __builtin_bswap32(value);
+#elif defined(_MSC_VER)
+    return _byteswap_ulong(value);
+#else
     value = (value & 0x0000FFFF) << 16 | (value & 0xFFFF0000) >> 16;
     value = (value & 0x00FF00FF) << 8 | (value & 0xFF00FF00) >> 8;
     return value;
+#endif
 }
 
 #endif // GPR_MACROS_H
@@ -167,6 +167,59 @@ finish:
     return bits;
 }
 
+/*!
+	@brief Advance the bitstream position without returning the skipped bits
+
+	The skip count is not limited to the size of the internal bit buffer.
+	Bits remaining in the buffer are dropped and whole bytes are skipped
+	directly in the underlying byte stream, so discarded payloads do not
+	pay the shift and mask cost of materializing each value.
+ */
+CODEC_ERROR SkipBits(BITSTREAM *stream, uint32_t count)
+{
+    // Drop bits that are already in the internal bit buffer
+    if (count < stream->count)
+    {
+        stream->buffer <<= count;
+        stream->count -= (BITCOUNT)count;
+        return CODEC_ERROR_OKAY;
+    }
+
+    count -= stream->count;
+    stream->buffer = 0;
+    stream->count = 0;
+
+    // Skip whole bytes directly in the underlying byte stream
+    if (count >= 8)
+    {
+        SkipBytes(stream->stream, count / 8);
+        count %= 8;
+    }
+
+    // Read and discard any residual bits
+    if (count > 0)
+    {
+        (void)GetBits(stream, (BITCOUNT)count);
+    }
+
+    return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Skip whole segments in the bitstream
+
+	The bitstream must be segment aligned when this routine is called,
+	so skipping a whole number of segments preserves the alignment by
+	construction and the caller does not need to realign the stream.
+ */
+CODEC_ERROR SkipSegments(BITSTREAM *stream, size_t count)
+{
+    // The bit buffer must be empty so the skip starts on a segment boundary
+    assert(IsAlignedSegment(stream));
+
+    return SkipBytes(stream->stream, count * sizeof(SEGMENT));
+}
+
 /*!
 	@brief Read more bits and append to an existing word of bits
  
@@ -336,16 +389,49 @@ CODEC_ERROR BitstreamCodecError(BITSTREAM *bitstream)
     return CodecErrorBitstream(bitstream->error);
 }
 
+/*!
+ @brief Return the next byte from the internal bit buffer
+ 
+ Specialized reader for the common case of a whole byte buffered in the
+ bit buffer.  The caller must check that at least eight bits are buffered
+ so this routine can extract the byte with a single shift instead of the
+ general shift and mask logic in @ref GetBits.  The name avoids a clash
+ with the byte stream routine @ref GetByte.
+ */
+STATIC_INLINE uint8_t GetBufferedByte(BITSTREAM *bitstream)
+{
+    uint8_t byte = (uint8_t)(bitstream->buffer >> (bit_word_count - 8));
+    bitstream->buffer <<= 8;
+    bitstream->count -= 8;
+    return byte;
+}
+
 /*!
  @brief Read a block of bytes from the bitstream
  */
 CODEC_ERROR GetByteArray(BITSTREAM *bitstream, uint8_t *array, size_t size)
 {
-    size_t i;
-    
-    for (i = 0; i < size; i++)
+    size_t i = 0;
+
+    // Drain whole bytes from the internal bit buffer
+    while (i < size && bitstream->count >= 8)
+    {
+        array[i++] = GetBufferedByte(bitstream);
+    }
+
+    // Read the remaining bytes from the byte stream in one operation
+    // instead of refilling the bit buffer for every byte (the buffer is
+    // empty once the drain loop has consumed the buffered bytes)
+    if (i < size && bitstream->count == 0)
+    {
+        GetBytes(bitstream->stream, &array[i], size - i);
+        return CODEC_ERROR_OKAY;
+    }
+
+    // The bitstream is not byte aligned so each byte spans two buffer words
+    for (; i < size; i++)
     {
-        array[i] = GetBits(bitstream, 8);
+        array[i] = (uint8_t)GetBits(bitstream, 8);
     }
     
     return CODEC_ERROR_OKAY;
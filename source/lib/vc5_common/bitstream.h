@@ -104,6 +104,10 @@ extern "C" {
 
     BITWORD GetBits(BITSTREAM *stream, BITCOUNT count);
 
+    CODEC_ERROR SkipBits(BITSTREAM *stream, uint32_t count);
+
+    CODEC_ERROR SkipSegments(BITSTREAM *stream, size_t count);
+
     CODEC_ERROR PutBits(BITSTREAM *stream, BITWORD bits, BITCOUNT count);
 
     BITWORD AddBits(BITSTREAM *stream, BITWORD bits, BITCOUNT count);
@@ -70,6 +70,11 @@ CODEC_ERROR PrepareCodecState(CODEC_STATE *codec)
 	// Set the default precision for encoding lowpass band coefficients
 	codec->lowpass_precision = 16;
 
+#if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS) && VC5_ENABLED_PART(VC5_PART_COLOR_SAMPLING)
+	// Cache the component count for the default pattern dimensions
+	codec->color_sampled_component_count = (uint8_t)(codec->pattern_width * codec->pattern_height + 2);
+#endif
+
 	//TODO: Set more default values in the codec state
 
 	return CODEC_ERROR_OKAY;
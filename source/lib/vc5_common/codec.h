@@ -190,6 +190,11 @@ typedef struct _codec_state
 	DIMENSION pattern_height;			//!< Height of the pattern elements (in rows)
 	DIMENSION components_per_sample;	//!< Number of components in each sample in the pattern element
 	PRECISION max_bits_per_component;	//!< Maximum number of bits for each value in the component arrays
+
+	//! Number of components in the inverse component transform when the
+	//! color sampling part is enabled (pattern size plus the two color
+	//! difference components), updated when the pattern dimensions are set
+	uint8_t color_sampled_component_count;
 #endif
 
 #if VC5_ENABLED_PART(VC5_PART_LAYERS)
@@ -225,9 +230,6 @@ typedef struct _codec_state
 	//! Most recent tag-value pair was a header parameter
 	bool header;
 
-	//! Most recent syntax element was a codeblock (large chunk element)
-	bool codeblock;
-
 	//! Parameters of the most recently decoded subband
 	struct
 	{
@@ -254,6 +256,30 @@ typedef struct _codec_state
 	//uint_fast8_t prescale_table[MAX_WAVELET_COUNT];
 	PRESCALE prescale_table[MAX_WAVELET_COUNT];
 
+	//! Maximum number of components in the inverse component transform
+#define MAX_COMPONENT_COUNT		8
+
+	/*!
+		@brief Inverse component transform read from the encoded sample
+
+		The bitstream interleaves the offset and scale with the matrix
+		at the end of each row, but the transform is stored here with
+		the matrix as one contiguous row-major block and the offsets and
+		scales in their own arrays so a future apply kernel can load
+		whole rows of coefficients with vector instructions.  The
+		transform is optional and the values are zero when no transform
+		chunk is present in the sample.
+	*/
+	uint8_t ict_matrix[MAX_COMPONENT_COUNT * MAX_COMPONENT_COUNT];
+	uint8_t ict_offset[MAX_COMPONENT_COUNT];
+	uint8_t ict_scale[MAX_COMPONENT_COUNT];
+
+	//! Inverse component permutation read from the encoded sample,
+	//! packed into 8-bit lanes (component i in bits 8i to 8i+7) so the
+	//! whole permutation fits in one register and can drive a byte
+	//! shuffle when the permutation is applied
+	uint64_t component_permutation;
+
 	//! Picture aspect ratio read from the encoded sample
 	struct _picture_aspect_ratio
 	{
@@ -35,6 +35,7 @@
 #include "types.h"
 #include "timer.h"
 #include "config.h"
+#include "cpu.h"
 #include "macros.h"
 #include "error.h"
 #include "pixel.h"
@@ -143,20 +143,12 @@ CODEC_ERROR ComputeCubicTable(int16_t cubic_table[], int cubic_table_length, int
 int32_t UncompandedValue(int32_t value)
 {
 #if 1	//CUBIC_COMPANDING
-	double cubic;
-	int32_t magnitude = absolute(value);
-
-	cubic = magnitude;
-	cubic *= magnitude;
-	cubic *= magnitude;
-	cubic *= 768;
-	//cubic /= 256*256*256;
-	cubic /= 255*255*255;
+	// Apply the curve to the magnitude and restore the sign branchlessly
+	// (the sign mask is all ones for negative values)
+	int32_t sign = value >> 31;
+	int32_t magnitude = UncompandedMagnitude((value ^ sign) - sign);
 
-	magnitude += (int32_t)cubic;
-
-	// Restore the sign
-	value = ((value < 0) ? neg(magnitude) : magnitude);
+	value = (magnitude ^ sign) - sign;
 #else
 	if (40 <= value && value < 264)
 	{
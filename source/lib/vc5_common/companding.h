@@ -22,6 +22,25 @@
 #ifndef COMPANDING_H
 #define COMPANDING_H
 
+/*!
+	@brief Invert the companding curve for a nonnegative coefficient magnitude
+
+	Defined inline so the dequantization loops can apply the cubic curve
+	without a function call per coefficient; the sign is handled by the
+	callers, which lets them use branchless sign arithmetic.
+*/
+STATIC_INLINE int32_t UncompandedMagnitude(int32_t magnitude)
+{
+	double cubic = magnitude;
+
+	cubic *= magnitude;
+	cubic *= magnitude;
+	cubic *= 768;
+	cubic /= 255*255*255;
+
+	return magnitude + (int32_t)cubic;
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
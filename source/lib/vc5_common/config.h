@@ -84,4 +84,12 @@ static const int default_internal_precision = 12;
 //! Number of rows of intermediate horizontal transform results
 #define ROW_BUFFER_COUNT	6
 
+//! Store the inverse component transform and permutation in the codec state
+//! as they are parsed.  Nothing downstream consumes the stored values yet,
+//! so builds that do not need them can set this to zero to reduce both chunk
+//! parsers to a bulk skip of the payload.
+#ifndef VC5_ENABLE_ICT_STORAGE
+#define VC5_ENABLE_ICT_STORAGE	1
+#endif
+
 #endif // CONFIG_H
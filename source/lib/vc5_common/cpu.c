@@ -0,0 +1,52 @@
+/*! @file cpu.c
+ *
+ *  @brief Implementation of the run time processor feature probe.
+ *
+ *  The codec selects between scalar and vector implementations of its hot
+ *  kernels at run time, so one binary runs on baseline processors and uses
+ *  the vector units where they exist.  The probe is executed once and the
+ *  result is cached, so the per call cost at the kernel dispatch points is
+ *  a load and a predictable branch.
+ *
+ *  @version 1.0.0
+ *
+ *  (C) Copyright 2018 GoPro Inc (http://gopro.com/).
+ *
+ *  Licensed under either:
+ *  - Apache License, Version 2.0, http://www.apache.org/licenses/LICENSE-2.0
+ *  - MIT license, http://opensource.org/licenses/MIT
+ *  at your option.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "common.h"
+
+/*!
+	@brief Return true if the processor executes AVX2 instructions
+
+	When the whole build targets AVX2 the probe folds to a constant.
+	Otherwise the processor is queried through the compiler builtins the
+	first time the probe runs and the answer is cached (the cached write
+	is idempotent, so concurrent first calls are benign).
+*/
+bool CpuHasAVX2(void)
+{
+#if defined(__AVX2__)
+    return true;
+#elif VC5_HAVE_AVX2
+    static int have_avx2 = -1;
+    if (have_avx2 < 0)
+    {
+        __builtin_cpu_init();
+        have_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return (have_avx2 != 0);
+#else
+    return false;
+#endif
+}
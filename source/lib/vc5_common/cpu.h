@@ -0,0 +1,56 @@
+/*! @file cpu.h
+ *
+ *  @brief Declaration of the run time processor feature probe used to
+ *  select the vector implementations of the hot codec kernels.
+ *
+ *  @version 1.0.0
+ *
+ *  (C) Copyright 2018 GoPro Inc (http://gopro.com/).
+ *
+ *  Licensed under either:
+ *  - Apache License, Version 2.0, http://www.apache.org/licenses/LICENSE-2.0
+ *  - MIT license, http://opensource.org/licenses/MIT
+ *  at your option.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef CPU_H
+#define CPU_H
+
+/*
+	The AVX2 kernels are compiled whenever the compiler can emit the
+	instructions and are selected at run time, so baseline builds without
+	vector flags still ship the vector code paths.
+
+	VC5_HAVE_AVX2 is true when the AVX2 kernels are compiled into the
+	build.  VC5_TARGET_AVX2 expands to the function attribute that allows
+	a translation unit compiled for a baseline processor to contain AVX2
+	code; it is empty when the whole build already targets AVX2.
+*/
+#if defined(__AVX2__)
+#define VC5_HAVE_AVX2	1
+#define VC5_TARGET_AVX2
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VC5_HAVE_AVX2	1
+#define VC5_TARGET_AVX2	__attribute__((target("avx2")))
+#else
+#define VC5_HAVE_AVX2	0
+#define VC5_TARGET_AVX2
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    bool CpuHasAVX2(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CPU_H
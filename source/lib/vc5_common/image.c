@@ -21,6 +21,12 @@
 
 #include "common.h"
 
+// Large component arrays are hinted onto transparent huge pages on Linux
+// to reduce TLB misses in the transforms that stream over them
+#if qLinux
+#include <sys/mman.h>
+#endif
+
 /*!
 	@brief Initialize the fields in an image data structure
 	This routine is the constructor for the image data type that
@@ -208,7 +214,7 @@ CODEC_ERROR ReleaseComponentArrays(gpr_allocator *allocator,
     
     for (channel = 0; channel < channel_count; channel++)
     {
-        allocator->Free( image->component_array_list[channel].data );
+        allocator->Free( image->component_array_list[channel].memory );
     }
     
     allocator->Free( image->component_array_list );
@@ -265,10 +271,12 @@ CODEC_ERROR AllocateComponentArray(gpr_allocator *allocator,
 {
     //COMPONENT_ARRAY *component_array = Alloc(allocator, sizeof(COMPONENT_ARRAY));
     
-    // Allocate space for the data in the component array
+    // Allocate space for the data in the component array with enough slack
+    // to align the first row to a cache line (the allocator contract only
+    // guarantees malloc alignment, so the base address is kept for Free)
     size_t pitch = width * sizeof(COMPONENT_VALUE);
     size_t size = height * pitch;
-    void *buffer = allocator->Alloc(size);
+    void *buffer = allocator->Alloc(size + 63);
     assert(buffer != NULL);
     if (! (buffer != NULL)) {
         return CODEC_ERROR_OUTOFMEMORY;
@@ -277,9 +285,24 @@ CODEC_ERROR AllocateComponentArray(gpr_allocator *allocator,
     component_array->width = width;
     component_array->height = height;
     component_array->pitch = pitch;
-    component_array->data = buffer;
+    component_array->memory = buffer;
+    component_array->data = (COMPONENT_VALUE *)(((uintptr_t)buffer + 63) & ~(uintptr_t)63);
     component_array->bits_per_component = bits_per_component;
     
+#if qLinux && defined(MADV_HUGEPAGE)
+    // Ask for huge pages under the interior of large arrays so that the
+    // write-then-read traffic of the transforms takes fewer TLB misses
+    // (the hint must cover whole pages, so the span is rounded inward)
+    if (size >= (size_t)(2 << 20))
+    {
+        uintptr_t begin = ((uintptr_t)component_array->data + 4095) & ~(uintptr_t)4095;
+        uintptr_t end = ((uintptr_t)component_array->data + size) & ~(uintptr_t)4095;
+        if (begin < end) {
+            (void)madvise((void *)begin, (size_t)(end - begin), MADV_HUGEPAGE);
+        }
+    }
+#endif
+    
     return CODEC_ERROR_OKAY;
 }
 
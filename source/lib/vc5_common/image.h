@@ -76,6 +76,7 @@ typedef struct _component_array
 	DIMENSION height;			//!< Height of the frame
 	size_t pitch;				//!< Distance between rows (in bytes)
 	COMPONENT_VALUE *data;		//!< Buffer for the array of component values
+	void *memory;				//!< Base address of the allocation that backs the data buffer
 
 	//! Number of bits per in each component value
 	PRECISION bits_per_component;
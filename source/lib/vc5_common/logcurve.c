@@ -20,9 +20,11 @@
 
 #include "common.h"
 
-uint16_t EncoderLogCurve[LOG_CURVE_TABLE_LENGTH];
+// One entry of padding so that a 32-bit gather of the last 16-bit entry
+// does not read past the end of the table
+uint16_t EncoderLogCurve[LOG_CURVE_TABLE_LENGTH + 1];
 
-uint16_t DecoderLogCurve[LOG_CURVE_TABLE_LENGTH];
+uint16_t DecoderLogCurve[LOG_CURVE_TABLE_LENGTH + 1];
 
 void SetupDecoderLogCurve(void)
 {
@@ -31,14 +33,27 @@ void SetupDecoderLogCurve(void)
     
     const int max_16_bit = (1 << 16) - 1;
     
+    // The table does not depend on any codec parameters, so build it once
+    // per process instead of recomputing the same entries for every frame
+    static bool initialized = false;
+
+    if (initialized) {
+        return;
+    }
+
     for( i = 0; i < log_table_size; i++ )
     {
         //input 12-bit, output 16-bit
         float input = i;
         float output = max_16_bit * (pow(113.0, input/4095.0) - 1.0)/112.0;
-        
+
         DecoderLogCurve[i]  = minimum( (int)output, max_16_bit );
     }
+
+    // Set the flag only after the table is complete so that a second
+    // caller entering during the fill rebuilds rather than reading a
+    // half-built table (the fill is idempotent)
+    initialized = true;
 }
 
 void SetupEncoderLogCurve(void)
@@ -46,6 +61,13 @@ void SetupEncoderLogCurve(void)
     int i;
     const int max_input_val = LOG_CURVE_TABLE_LENGTH - 1;
     
+    // Parameter independent like the decoder curve, so build it only once
+    static bool initialized = false;
+
+    if (initialized) {
+        return;
+    }
+
     for( i = 0; i < LOG_CURVE_TABLE_LENGTH; i++ )
     {
         //input 16-bit, output 12-bit
@@ -54,5 +76,10 @@ void SetupEncoderLogCurve(void)
 
         EncoderLogCurve[i]  = ( (uint16_t)output );
     }
+
+    // Set the flag only after the table is complete so that a second
+    // caller entering during the fill rebuilds rather than reading a
+    // half-built table (the fill is idempotent)
+    initialized = true;
 }
 
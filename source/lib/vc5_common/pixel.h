@@ -84,11 +84,10 @@ STATIC_INLINE PIXEL ClampPixel(int32_t value)
 	// Check for values that are outside the range (for debugging)
 	assert(PIXEL_MIN <= value && value <= PIXEL_MAX);
 
-	if (value < PIXEL_MIN)
-		value = PIXEL_MIN;
-	else
-		if (value > PIXEL_MAX)
-			value = PIXEL_MAX;
+	// Clamp with conditional expressions so the compiler can emit
+	// conditional moves instead of branches
+	value = (value < PIXEL_MIN) ? PIXEL_MIN : value;
+	value = (value > PIXEL_MAX) ? PIXEL_MAX : value;
 
 	return (PIXEL)value;
 }
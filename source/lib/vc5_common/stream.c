@@ -22,14 +22,105 @@
  *  limitations under the License.
  */
 
+// Expose the POSIX memory mapping interfaces when compiling as strict C99
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
 #include "common.h"
 
+// A read-only file stream is mapped into memory on platforms that support
+// memory mapping so that the hot accessors run on the memory stream path
+// without copying through the stdio buffer
+#if qLinux || qMacOS || qiPhone || qAndroid
+#define STREAM_USE_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#define STREAM_USE_MMAP 0
+#endif
+
+#if qLinux
+#include <fcntl.h>
+#endif
+
+//! Size of the stdio buffer for file streams (the default BUFSIZ is too
+//! small for multi-megabyte encoded samples and causes excess syscalls)
+#define STREAM_IO_BUFFER_SIZE (64 * 1024)
+
 // Local functions
 CODEC_ERROR GetBlockFile(STREAM *stream, void *buffer, size_t size, size_t offset);
 CODEC_ERROR PutBlockFile(STREAM *stream, void *buffer, size_t size, size_t offset);
 CODEC_ERROR GetBlockMemory(STREAM *stream, void *buffer, size_t size, size_t offset);
 CODEC_ERROR PutBlockMemory(STREAM *stream, void *buffer, size_t size, size_t offset);
 
+#if ENABLED(SSE)
+#include <tmmintrin.h>
+#endif
+
+/*!
+	@brief Load a word from an address that need not be word aligned
+
+	The compiler reduces this to a single unaligned load instruction on
+	architectures that support unaligned access.
+*/
+STATIC_INLINE uint32_t UnalignedLoad32(const void *address)
+{
+#if defined(__GNUC__)
+	typedef uint32_t __attribute__((aligned(1), may_alias)) unaligned_uint32_t;
+	return *(const unaligned_uint32_t *)address;
+#else
+	uint32_t value;
+	memcpy(&value, address, sizeof(value));
+	return value;
+#endif
+}
+
+/*!
+	@brief Store a word to an address that need not be word aligned
+*/
+STATIC_INLINE void UnalignedStore32(void *address, uint32_t value)
+{
+#if defined(__GNUC__)
+	typedef uint32_t __attribute__((aligned(1), may_alias)) unaligned_uint32_t;
+	*(unaligned_uint32_t *)address = value;
+#else
+	memcpy(address, &value, sizeof(value));
+#endif
+}
+
+// Accessors specialized for each type of stream (bound when the stream is opened)
+static BITWORD GetWordFile(STREAM *stream);
+static BITWORD GetWordMemory(STREAM *stream);
+static uint8_t GetByteFile(STREAM *stream);
+static uint8_t GetByteMemory(STREAM *stream);
+static CODEC_ERROR PutWordFile(STREAM *stream, BITWORD word);
+static CODEC_ERROR PutWordMemory(STREAM *stream, BITWORD word);
+static CODEC_ERROR PutByteFile(STREAM *stream, uint8_t byte);
+static CODEC_ERROR PutByteMemory(STREAM *stream, uint8_t byte);
+
+/*!
+	@brief Bind the word and byte accessors for a file stream
+*/
+static void BindFileAccessors(STREAM *stream)
+{
+	stream->get_word = GetWordFile;
+	stream->get_byte = GetByteFile;
+	stream->put_word = PutWordFile;
+	stream->put_byte = PutByteFile;
+}
+
+/*!
+	@brief Bind the word and byte accessors for a memory stream
+*/
+static void BindMemoryAccessors(STREAM *stream)
+{
+	stream->get_word = GetWordMemory;
+	stream->get_byte = GetByteMemory;
+	stream->put_word = PutWordMemory;
+	stream->put_byte = PutByteMemory;
+}
+
 /*!
 	@brief Open a stream for reading bytes from the specified file
 
@@ -51,9 +142,50 @@ CODEC_ERROR OpenStream(STREAM *stream, const char *pathname)
 		return CODEC_ERROR_OPEN_FILE_FAILED;
 	}
 
+	// Reads are strictly sequential, so use a larger stdio buffer and let
+	// the kernel widen its readahead window
+	setvbuf(stream->location.file.iobuf, NULL, _IOFBF, STREAM_IO_BUFFER_SIZE);
+#if qLinux
+	posix_fadvise(fileno(stream->location.file.iobuf), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+#if STREAM_USE_MMAP
+	// Map the file into memory so that the stream uses the faster memory
+	// accessors without copying bytes through the stdio buffer
+	{
+		struct stat info;
+		if (fstat(fileno(stream->location.file.iobuf), &info) == 0 && info.st_size > 0)
+		{
+			void *map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE,
+							 fileno(stream->location.file.iobuf), 0);
+			if (map != MAP_FAILED)
+			{
+				// The mapping remains valid after the file is closed
+				(void)madvise(map, (size_t)info.st_size, MADV_SEQUENTIAL);
+				fclose(stream->location.file.iobuf);
+
+				// Bind the stream to the mapped pages as a memory stream
+				stream->location.memory.buffer = map;
+				stream->location.memory.size = (size_t)info.st_size;
+				stream->cur = (uint8_t *)map;
+				stream->end = (uint8_t *)map + (size_t)info.st_size;
+				stream->type = STREAM_TYPE_MEMORY;
+				stream->access = STREAM_ACCESS_READ;
+				stream->mapped = true;
+				BindMemoryAccessors(stream);
+
+				stream->byte_count = 0;
+
+				return CODEC_ERROR_OKAY;
+			}
+		}
+	}
+#endif
+
 	// Set the stream type and access
 	stream->type = STREAM_TYPE_FILE;
 	stream->access = STREAM_ACCESS_READ;
+	BindFileAccessors(stream);
 
 	// Clear the number of bytes read from the stream
 	stream->byte_count = 0;
@@ -82,9 +214,14 @@ CODEC_ERROR CreateStream(STREAM *stream, const char *pathname)
 		return CODEC_ERROR_CREATE_FILE_FAILED;
 	}
 
+	// Writes are strictly sequential, so use a larger stdio buffer to
+	// reduce the number of write syscalls
+	setvbuf(stream->location.file.iobuf, NULL, _IOFBF, STREAM_IO_BUFFER_SIZE);
+
 	// Set the stream type and access
 	stream->type = STREAM_TYPE_FILE;
 	stream->access = STREAM_ACCESS_WRITE;
+	BindFileAccessors(stream);
 
 	// Clear the number of bytes written to the stream
 	stream->byte_count = 0;
@@ -92,6 +229,42 @@ CODEC_ERROR CreateStream(STREAM *stream, const char *pathname)
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Close a stream and release any resources bound to it
+
+	The stream data structure itself is not deallocated.  A stream that was
+	mapped into memory by @ref OpenStream is unmapped; a stream bound to an
+	open file is closed.  Memory streams bound to a caller-owned buffer are
+	left untouched.
+*/
+CODEC_ERROR CloseStream(STREAM *stream)
+{
+	assert(stream != NULL);
+	if (! (stream != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+#if STREAM_USE_MMAP
+	if (stream->mapped)
+	{
+		munmap(stream->location.memory.buffer, stream->location.memory.size);
+		stream->mapped = false;
+		stream->type = STREAM_TYPE_UNKNOWN;
+		return CODEC_ERROR_OKAY;
+	}
+#endif
+
+	if (stream->type == STREAM_TYPE_FILE && stream->location.file.iobuf != NULL)
+	{
+		fclose(stream->location.file.iobuf);
+		stream->location.file.iobuf = NULL;
+	}
+
+	stream->type = STREAM_TYPE_UNKNOWN;
+
+	return CODEC_ERROR_OKAY;
+}
+
 /*!
 	@brief Read a word from a byte stream
 
@@ -103,61 +276,114 @@ CODEC_ERROR CreateStream(STREAM *stream, const char *pathname)
 	or an error reading from the byte stream.
 */
 BITWORD GetWord(STREAM *stream)
+{
+    assert(stream != NULL && stream->get_word != NULL);
+    return stream->get_word(stream);
+}
+
+/*!
+	@brief Read a word from a file stream
+*/
+static BITWORD GetWordFile(STREAM *stream)
 {
     BITWORD buffer = 0;
-    size_t bytes_read = sizeof(buffer);
-    
-    assert(stream != NULL);
-    
-    switch (stream->type)
-    {
-        case STREAM_TYPE_FILE:
-            bytes_read = fread(&buffer, 1, sizeof(buffer), stream->location.file.iobuf);
-            assert(bytes_read == sizeof(buffer));
-            break;
-            
-        case STREAM_TYPE_MEMORY:
-            memcpy(&buffer, (uint8_t *)stream->location.memory.buffer + stream->byte_count, sizeof(buffer));
-            break;
-            
-        default:
-            assert(0);
-            break;
-    }
-    
+    size_t bytes_read = fread(&buffer, 1, sizeof(buffer), stream->location.file.iobuf);
+    assert(bytes_read == sizeof(buffer));
+
     if (bytes_read > 0)
         stream->byte_count += sizeof(buffer);
-    
-	return buffer;
+
+    return buffer;
 }
 
 /*!
-	@brief Read a byte from a byte stream
+	@brief Read a word from a memory stream (buffer)
 */
-uint8_t GetByte(STREAM *stream)
+//! Distance (in bytes) to prefetch ahead of the current read position
+//! (about four cache lines, enough to hide the latency of the next lines
+//! while the bitstream consumes the words already loaded)
+#define STREAM_PREFETCH_AHEAD 256
+
+static BITWORD GetWordMemory(STREAM *stream)
 {
-    assert(stream != NULL);
-    int byte = 0;
-    
-    switch (stream->type)
+    BITWORD buffer = UnalignedLoad32(stream->cur);
+#if defined(__GNUC__)
+    // Non-temporal prefetch of the bytes that will be read soon
+    __builtin_prefetch(stream->cur + STREAM_PREFETCH_AHEAD, 0, 0);
+#endif
+    stream->cur += sizeof(buffer);
+    stream->byte_count += sizeof(buffer);
+    return buffer;
+}
+
+/*!
+	@brief Read four words from a byte stream and convert each to host byte order
+
+	Bulk form of @ref GetWord used to refill the bitstream buffer.  The words
+	in the stream are stored in network (big endian) order and are returned in
+	host byte order, so the caller does not apply @ref Swap32 to the results.
+*/
+CODEC_ERROR GetWords4(STREAM *stream, BITWORD words[4])
+{
+    assert(stream != NULL && words != NULL);
+
+    if (stream->type == STREAM_TYPE_MEMORY)
     {
-        case STREAM_TYPE_FILE:
-            byte = fgetc(stream->location.file.iobuf);
-            break;
-            
-        case STREAM_TYPE_MEMORY:
-            byte = ((uint8_t *)stream->location.memory.buffer)[stream->byte_count];            
-            break;
-            
-        default:
-            assert(0);
-            break;
+        const uint8_t *bytes = stream->cur;
+#if ENABLED(SSE)
+        const __m128i bswap_mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        __m128i v = _mm_loadu_si128((const __m128i *)bytes);
+        _mm_storeu_si128((__m128i *)words, _mm_shuffle_epi8(v, bswap_mask));
+#else
+        words[0] = Swap32(UnalignedLoad32(bytes + 0));
+        words[1] = Swap32(UnalignedLoad32(bytes + 4));
+        words[2] = Swap32(UnalignedLoad32(bytes + 8));
+        words[3] = Swap32(UnalignedLoad32(bytes + 12));
+#endif
+        stream->cur += 4 * sizeof(BITWORD);
+        stream->byte_count += 4 * sizeof(BITWORD);
     }
-    
+    else
+    {
+        int i;
+        for (i = 0; i < 4; i++) {
+            words[i] = Swap32(GetWord(stream));
+        }
+    }
+
+    return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Read a byte from a byte stream
+*/
+uint8_t GetByte(STREAM *stream)
+{
+    assert(stream != NULL && stream->get_byte != NULL);
+    return stream->get_byte(stream);
+}
+
+/*!
+	@brief Read a byte from a file stream
+*/
+static uint8_t GetByteFile(STREAM *stream)
+{
+    // The rare end of file return value truncates to a byte without a
+    // range check since callers detect the end of the encoded sample
+    // from the byte count (this routine runs for every byte read)
+    unsigned int byte = (unsigned int)fgetc(stream->location.file.iobuf);
     stream->byte_count++;
-    assert(byte >= 0 && (byte & ~0xFF) == 0);
-    
-	return (uint8_t)byte;
+    return (uint8_t)byte;
+}
+
+/*!
+	@brief Read a byte from a memory stream (buffer)
+*/
+static uint8_t GetByteMemory(STREAM *stream)
+{
+    uint8_t byte = *(stream->cur++);
+    stream->byte_count++;
+    return byte;
 }
 
 /*!
@@ -171,36 +397,40 @@ uint8_t GetByte(STREAM *stream)
 	writing to the byte stream.
 */
 CODEC_ERROR PutWord(STREAM *stream, BITWORD word)
+{
+	assert(stream != NULL && stream->put_word != NULL);
+	return stream->put_word(stream, word);
+}
+
+/*!
+	@brief Write a word to a file stream
+*/
+static CODEC_ERROR PutWordFile(STREAM *stream, BITWORD word)
 {
 	size_t written;
 
-    word = Swap32(word);
-    
-	assert(stream != NULL);
-    
-	switch (stream->type)
-	{
-	case STREAM_TYPE_FILE:
-		written = fwrite(&word, sizeof(word), 1, stream->location.file.iobuf);
-		if (written == 0)
-			return CODEC_ERROR_FILE_WRITE_FAILED;
-		break;
+	word = Swap32(word);
 
-	case STREAM_TYPE_MEMORY:
-        {
-            uint8_t* buffer = (uint8_t *)stream->location.memory.buffer + stream->byte_count;
-            
-            memcpy(buffer, &word, sizeof(word));            
-        }
-		break;
+	written = fwrite(&word, sizeof(word), 1, stream->location.file.iobuf);
+	if (written == 0)
+		return CODEC_ERROR_FILE_WRITE_FAILED;
 
-	default:
-		assert(0);
-		break;
-	}
+	stream->byte_count += sizeof(word);
+	stream->dirty = true;
+
+	return CODEC_ERROR_OKAY;
+}
 
+/*!
+	@brief Write a word to a memory stream (buffer)
+*/
+static CODEC_ERROR PutWordMemory(STREAM *stream, BITWORD word)
+{
+	UnalignedStore32(stream->cur, Swap32(word));
+
+	stream->cur += sizeof(word);
 	stream->byte_count += sizeof(word);
-    
+
 	return CODEC_ERROR_OKAY;
 }
 
@@ -209,26 +439,30 @@ CODEC_ERROR PutWord(STREAM *stream, BITWORD word)
 */
 CODEC_ERROR PutByte(STREAM *stream, uint8_t byte)
 {
-	assert(stream != NULL);
-
-	//assert(byte >= 0 && (byte & ~0xFF) == 0);
+	assert(stream != NULL && stream->put_byte != NULL);
+	return stream->put_byte(stream, byte);
+}
 
-	switch (stream->type)
-	{
-	case STREAM_TYPE_FILE:
-		if (fputc(byte, stream->location.file.iobuf) == EOF)
-			return CODEC_ERROR_FILE_WRITE_FAILED;
-		break;
+/*!
+	@brief Write a byte to a file stream
+*/
+static CODEC_ERROR PutByteFile(STREAM *stream, uint8_t byte)
+{
+	if (fputc(byte, stream->location.file.iobuf) == EOF)
+		return CODEC_ERROR_FILE_WRITE_FAILED;
 
-	case STREAM_TYPE_MEMORY:
-		((uint8_t *)stream->location.memory.buffer)[stream->byte_count] = byte;
-		break;
+	stream->byte_count++;
+	stream->dirty = true;
 
-	default:
-		assert(0);
-		break;
-	}
+	return CODEC_ERROR_OKAY;
+}
 
+/*!
+	@brief Write a byte to a memory stream (buffer)
+*/
+static CODEC_ERROR PutByteMemory(STREAM *stream, uint8_t byte)
+{
+	*(stream->cur++) = byte;
 	stream->byte_count++;
 
 	return CODEC_ERROR_OKAY;
@@ -247,13 +481,79 @@ CODEC_ERROR RewindStream(STREAM *stream)
     if( stream->type == STREAM_TYPE_FILE )
     {
         if (stream->location.file.iobuf != NULL) {
-            assert(fseek(stream->location.file.iobuf, 0, SEEK_SET) == 0);
-            return CODEC_ERROR_BITSTREAM;
+            if (fseek(stream->location.file.iobuf, 0, SEEK_SET) != 0) {
+                return CODEC_ERROR_FILE_SEEK;
+            }
         }
     }
 
 	stream->byte_count = 0;
 
+	// Only a memory stream uses the direct buffer pointers; they stay
+	// NULL for a file stream so the accessors take the buffered path
+	if (stream->type == STREAM_TYPE_MEMORY) {
+		stream->cur = (uint8_t *)stream->location.memory.buffer;
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Read a block of bytes from the current position in the stream
+
+	Bulk form of @ref GetByte that reads the block with a single copy
+	(memory stream) or a single read (file stream) instead of one call
+	per byte.
+*/
+CODEC_ERROR GetBytes(STREAM *stream, void *buffer, size_t size)
+{
+	assert(stream != NULL && buffer != NULL);
+
+	if (stream->type == STREAM_TYPE_MEMORY)
+	{
+		memcpy(buffer, stream->cur, size);
+		stream->cur += size;
+	}
+	else
+	{
+		size_t bytes_read = fread(buffer, 1, size, stream->location.file.iobuf);
+		if (bytes_read != size) {
+			return CODEC_ERROR_FILE_READ;
+		}
+	}
+
+	stream->byte_count += size;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Write a block of bytes at the current position in the stream
+
+	Bulk form of @ref PutByte that writes the block with a single copy
+	(memory stream) or a single write (file stream) instead of one call
+	per byte.
+*/
+CODEC_ERROR PutBytes(STREAM *stream, const void *buffer, size_t size)
+{
+	assert(stream != NULL && buffer != NULL);
+
+	if (stream->type == STREAM_TYPE_MEMORY)
+	{
+		memcpy(stream->cur, buffer, size);
+		stream->cur += size;
+	}
+	else
+	{
+		size_t bytes_written = fwrite(buffer, 1, size, stream->location.file.iobuf);
+		if (bytes_written != size) {
+			return CODEC_ERROR_FILE_WRITE_FAILED;
+		}
+		stream->dirty = true;
+	}
+
+	stream->byte_count += size;
+
 	return CODEC_ERROR_OKAY;
 }
 
@@ -262,6 +562,26 @@ CODEC_ERROR RewindStream(STREAM *stream)
 */
 CODEC_ERROR SkipBytes(STREAM *stream, size_t size)
 {
+	if (stream->type == STREAM_TYPE_MEMORY)
+	{
+		// Advance the stream without touching the skipped bytes
+		stream->cur += size;
+		stream->byte_count += size;
+		return CODEC_ERROR_OKAY;
+	}
+
+	if (stream->type == STREAM_TYPE_FILE && stream->access == STREAM_ACCESS_READ)
+	{
+		// Seek past the skipped payload in one operation instead of
+		// reading it byte by byte (also keeps the payload out of cache)
+		if (fseek(stream->location.file.iobuf, (long)size, SEEK_CUR) == 0)
+		{
+			stream->byte_count += size;
+			return CODEC_ERROR_OKAY;
+		}
+		// The stream is not seekable so fall through to the byte reads
+	}
+
 	for (; size > 0; size--)
 	{
 		(void)GetByte(stream);
@@ -274,10 +594,25 @@ CODEC_ERROR SkipBytes(STREAM *stream, size_t size)
 */
 CODEC_ERROR PadBytes(STREAM *stream, size_t size)
 {
-	const uint8_t byte = 0;
-	for (; size > 0; size--)
+	static const uint8_t padding[16] = { 0 };
+
+	if (stream->type == STREAM_TYPE_MEMORY)
+	{
+		memset(stream->cur, 0, size);
+		stream->cur += size;
+		stream->byte_count += size;
+		return CODEC_ERROR_OKAY;
+	}
+
+	// Write the padding in chunks to avoid one call per byte
+	while (size > 0)
 	{
-		PutByte(stream, byte);
+		size_t chunk = (size < sizeof(padding)) ? size : sizeof(padding);
+		CODEC_ERROR error = PutBytes(stream, padding, chunk);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+		size -= chunk;
 	}
 	return CODEC_ERROR_OKAY;
 }
@@ -292,12 +627,13 @@ CODEC_ERROR FlushStream(STREAM *stream)
 		return CODEC_ERROR_NULLPTR;
 	}
 
-	if (stream->type == STREAM_TYPE_FILE)
+	if (stream->type == STREAM_TYPE_FILE && stream->dirty)
 	{
 		int result = fflush(stream->location.file.iobuf);
 		if (result != 0) {
 			return CODEC_ERROR_FILE_FLUSH_FAILED;
 		}
+		stream->dirty = false;
 	}
 
 	return CODEC_ERROR_OKAY;
@@ -319,11 +655,16 @@ CODEC_ERROR OpenStreamBuffer(STREAM *stream, void *buffer, size_t size)
     // Bind the stream to the buffer
     stream->location.memory.buffer = buffer;
     stream->location.memory.size = size;
+
+    // Cache the current position and end of the buffer
+    stream->cur = (uint8_t *)buffer;
+    stream->end = (uint8_t *)buffer + size;
     
     // Set the stream type and access
     stream->type = STREAM_TYPE_MEMORY;
     stream->access = STREAM_ACCESS_READ;
-    
+    BindMemoryAccessors(stream);
+
     // Clear the number of bytes written to the stream
     stream->byte_count = 0;
     
@@ -347,9 +688,14 @@ CODEC_ERROR CreateStreamBuffer(STREAM *stream, void *buffer, size_t size)
 	stream->location.memory.buffer = buffer;
 	stream->location.memory.size = size;
 
+	// Cache the current position and end of the buffer
+	stream->cur = (uint8_t *)buffer;
+	stream->end = (uint8_t *)buffer + size;
+
 	// Set the stream type and access
 	stream->type = STREAM_TYPE_MEMORY;
 	stream->access = STREAM_ACCESS_WRITE;
+	BindMemoryAccessors(stream);
 
 	// Clear the number of bytes written to the stream
 	stream->byte_count = 0;
@@ -448,6 +794,14 @@ CODEC_ERROR GetBlockFile(STREAM *stream, void *buffer, size_t size, size_t offse
 CODEC_ERROR GetBlockMemory(STREAM *stream, void *buffer, size_t size, size_t offset)
 {
 	uint8_t *block = (uint8_t *)stream->location.memory.buffer + offset;
+
+	// The common case is reading back a single word (the size field of a
+	// chunk) so specialize it to one load instead of a generic copy
+	if (size == sizeof(uint32_t)) {
+		*(uint32_t *)buffer = UnalignedLoad32(block);
+		return CODEC_ERROR_OKAY;
+	}
+
 	memcpy(buffer, block, size);
 	return CODEC_ERROR_OKAY;
 }
@@ -501,6 +855,7 @@ CODEC_ERROR PutBlockFile(STREAM *stream, void *buffer, size_t size, size_t offse
 	if (fwrite(buffer, size, 1, file) != 1) {
 		return CODEC_ERROR_FILE_WRITE;
 	}
+	stream->dirty = true;
 
 	// Return to the previous position in the file
 	// if (fseek(file, (long)position, SEEK_SET) != 0) {
@@ -517,6 +872,14 @@ CODEC_ERROR PutBlockFile(STREAM *stream, void *buffer, size_t size, size_t offse
 CODEC_ERROR PutBlockMemory(STREAM *stream, void *buffer, size_t size, size_t offset)
 {
 	uint8_t *block = (uint8_t *)stream->location.memory.buffer + offset;
+
+	// The common case is patching a single word (the size field of a
+	// chunk) so specialize it to one store instead of a generic copy
+	if (size == sizeof(uint32_t)) {
+		UnalignedStore32(block, *(const uint32_t *)buffer);
+		return CODEC_ERROR_OKAY;
+	}
+
 	memcpy(block, buffer, size);
 	return CODEC_ERROR_OKAY;
 }
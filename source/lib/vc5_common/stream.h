@@ -57,13 +57,45 @@ typedef enum _stream_access
 
 	It is intended that the byte stream can be enhanced to read (write)
 	encoded images from (into) a track in a media container.
+
+	The stream is kept small so that the hot fields (type and byte count)
+	share a cache line with the location of the stream.  Callers that hold
+	one stream per channel no longer drag a cold word cache into the cache
+	hierarchy on every access.
 */
-#define STREAM_CACHE_SIZE 16
-typedef struct _stream
+typedef struct _stream STREAM;
+
+struct _stream
 {
 	STREAM_TYPE type;		//!< Type of stream (file or memory buffer)
 	STREAM_ACCESS access;	//!< Type of access (read or write)
 
+	size_t byte_count;		//!< Number of bytes read or written to the stream
+
+	//! Current position and end of a memory stream.  Caching the position
+	//! as a pointer keeps the hot accessors from recomputing the buffer
+	//! address from the byte count on every call and gives bounds checks a
+	//! single comparison against the end pointer.  The pointers are kept in
+	//! step with the byte count and are NULL for file streams.
+	uint8_t *cur;
+	uint8_t *end;
+
+	//! True if the stream is a file that was mapped into memory by OpenStream
+	//! (the mapping is released by CloseStream)
+	bool mapped;
+
+	//! True if bytes have been written to a file stream since the last flush
+	//! (lets FlushStream skip the fflush syscall when nothing is pending)
+	bool dirty;
+
+	//! Word and byte accessors specialized for the type of stream
+	//! (bound when the stream is opened so that the hot paths do not
+	//! branch on the stream type for every word)
+	BITWORD (*get_word)(STREAM *stream);
+	uint8_t (*get_byte)(STREAM *stream);
+	CODEC_ERROR (*put_word)(STREAM *stream, BITWORD word);
+	CODEC_ERROR (*put_byte)(STREAM *stream, uint8_t byte);
+
 	//! Union of parameters for different types of streams
 	union _location
 	{
@@ -71,8 +103,6 @@ typedef struct _stream
 		struct _file
 		{
 			FILE *iobuf;	//!< Binary file that contains the stream
-			BITWORD cache[STREAM_CACHE_SIZE];
-			int		cache_index;
 
 		} file;			//!< Parameters for a stream in a binary file
 
@@ -88,9 +118,29 @@ typedef struct _stream
 
 	} location;		//!< Location of the byte stream (file or memory buffer)
 
-	size_t byte_count;		//!< Number of bytes read or written to the stream
+};
+
+/*!
+	@brief Return the number of bytes remaining in the stream
+
+	For a memory stream the remaining length is the distance between the
+	current position and the end of the buffer.  File streams are read
+	through a buffered file so there is no fixed end pointer; the maximum
+	size is returned so that callers treat the stream as unbounded.
 
-} STREAM;
+	Parsers that consume a payload of known size through the unchecked
+	memory stream accessors validate the payload against this bound once
+	at entry instead of bounds checking every interior read.
+*/
+STATIC_INLINE size_t RemainingStreamBytes(const STREAM *stream)
+{
+	if (stream->type == STREAM_TYPE_MEMORY)
+	{
+		return (size_t)(stream->end - stream->cur);
+	}
+
+	return SIZE_MAX;
+}
 
 #ifdef __cplusplus
 extern "C" {
@@ -100,12 +150,20 @@ extern "C" {
 
     CODEC_ERROR CreateStream(STREAM *stream, const char *pathname);
 
+    CODEC_ERROR CloseStream(STREAM *stream);
+
     CODEC_ERROR RewindStream(STREAM *stream);
 
     BITWORD GetWord(STREAM *stream);
 
+    CODEC_ERROR GetWords4(STREAM *stream, BITWORD words[4]);
+
     uint8_t GetByte(STREAM *stream);
 
+    CODEC_ERROR GetBytes(STREAM *stream, void *buffer, size_t size);
+
+    CODEC_ERROR PutBytes(STREAM *stream, const void *buffer, size_t size);
+
     CODEC_ERROR SkipBytes(STREAM *stream, size_t size);
 
     CODEC_ERROR PutWord(STREAM *stream, BITWORD word);
@@ -75,52 +75,6 @@
 #define CODEC_FLAGS_PROTECTED			0x01	//!< Copy protection flags
 #define CODEC_FLAGS_PROTECTION_MASK		0x01	//!< Unused bits must be zero
 
-/*!
-	@brief Check that the bitstream is aligned to a segment boundary
- 
- This function definition duplicates the same function in common/src/syntax.c,
- but that file includes definitions intended only for the encoder.
- 
- @todo Remove duplicate function definitions.
- */
-bool IsAlignedSegment(BITSTREAM *stream)
-{
-    return (stream->count == 0 || stream->count == bit_word_count);
-}
-
-/*!
-	@brief Convert the tag to an optional tag
-
-	An optional tag has a negative value.
-*/
-TAGWORD OptionalTag(TAGWORD tag)
-{
-	return ((tag < 0) ? tag : neg(tag));
-}
-
-/*!
-	@brief Convert the tag to a required tag
-
-	An optional tag has a negative value.
-*/
-TAGWORD RequiredTag(TAGWORD tag)
-{
-	return ((tag >= 0) ? tag : neg(tag));
-}
-
-
-/*!
-	@brief Check that the bitstream is aligned to a tag word boundary
-
-	@todo Check the places in the code where this function is used to
-	determine whether the bitstream should actually be aligned to a
-	segment boundary.
-*/
-bool IsAlignedTag(BITSTREAM *stream)
-{
-	return ((stream->count % BITSTREAM_TAG_SIZE) == 0);
-}
-
 /*!
 	@brief Pack the vector of prescale values into a single word
 
@@ -133,18 +87,19 @@ bool IsAlignedTag(BITSTREAM *stream)
 */
 TAGWORD PackTransformPrescale(TRANSFORM *transform)
 {
-	TAGWORD packed_prescale = 0;
-	int i;
+	const PRESCALE *prescale = transform->prescale;
+	uint32_t packed_prescale;
 
-	// Encode the prescale values that are actually used
-	for (i = 0; i < MAX_WAVELET_COUNT; i++)
-	{
-		assert((transform->prescale[i] & ~0x03) == 0);
-		packed_prescale += transform->prescale[i] << (14 - i * 2);
-	}
+	// Each prescale value is a two bit field packed from the most significant
+	// end of the word with the first wavelet level in the highest position
+	// (masking each value to two bits makes the pack branchless and keeps
+	// out-of-range values from corrupting neighboring fields)
+	packed_prescale = ((uint32_t)(prescale[0] & 0x03) << 14) |
+					  ((uint32_t)(prescale[1] & 0x03) << 12) |
+					  ((uint32_t)(prescale[2] & 0x03) << 10);
 
-	// The remaining prescale values with filled with zeros
+	// The remaining prescale values are filled with zeros
 
-	return packed_prescale;
+	return (TAGWORD)packed_prescale;
 }
 
@@ -69,12 +69,55 @@ typedef enum _special_marker
 #define ENCODED_QUALITY_HIGH_SHIFT	16			//!< Shift for the high part of the quality
 #define ENCODED_QUALITY_HIGH_MASK	0xFFFF		//!< Mask for the high part of the quality
 
+/*!
+	@brief Convert the tag to a required tag
+
+	An optional tag has a negative value.  The conversion uses a branchless
+	absolute value since the sign of the tag is not predictable at the call
+	sites in the bitstream reader and writer.
+*/
+STATIC_INLINE TAGWORD RequiredTag(TAGWORD tag)
+{
+	TAGWORD mask = (TAGWORD)(tag >> 15);
+	return (TAGWORD)((tag ^ mask) - mask);
+}
+
+/*!
+	@brief Convert the tag to an optional tag
+
+	An optional tag has a negative value.
+*/
+STATIC_INLINE TAGWORD OptionalTag(TAGWORD tag)
+{
+	return (TAGWORD)neg(RequiredTag(tag));
+}
+
+/*!
+	@brief Check that the bitstream is aligned to a tag word boundary
+
+	The tag size is a power of two so the modulo reduces to a bit test.
+
+	@todo Check the places in the code where this function is used to
+	determine whether the bitstream should actually be aligned to a
+	segment boundary.
+*/
+STATIC_INLINE bool IsAlignedTag(BITSTREAM *stream)
+{
+	return ((stream->count & (CODEC_TAG_SIZE - 1)) == 0);
+}
+
+/*!
+	@brief Check that the bitstream is aligned to a segment boundary
+*/
+STATIC_INLINE bool IsAlignedSegment(BITSTREAM *stream)
+{
+	return (stream->count == 0 || stream->count == bit_word_count);
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-TAGWORD RequiredTag(TAGWORD tag);
-
 //TAGVALUE GetSegment(BITSTREAM *stream);
 
 //TAGWORD GetValue(BITSTREAM *stream, int tag);
@@ -88,8 +131,6 @@ CODEC_ERROR PutTagPairOptional(BITSTREAM *stream, int tag, int value);
 // Output a tag that marks a place in the bitstream for debugging
 CODEC_ERROR PutTagMarker(BITSTREAM *stream, uint32_t  marker, int size);
 
-TAGWORD OptionalTag(TAGWORD tag);
-
 //bool IsTagOptional(TAGWORD tag);
 
 //bool IsTagRequired(TAGWORD tag);
@@ -98,14 +139,6 @@ TAGWORD OptionalTag(TAGWORD tag);
 
 //CODEC_ERROR AlignBitsTag(BITSTREAM *stream);
 
-bool IsLowPassHeaderMarker(int marker);
-bool IsLowPassBandMarker(int marker);
-bool IsHighPassBandMarker(int marker);
-
-bool IsAlignedTag(BITSTREAM *stream);
-
-bool IsAlignedSegment(BITSTREAM *stream);
-
 // Write an index block for the sample bands
 CODEC_ERROR PutGroupIndex(BITSTREAM *stream,
 						  void *index_table[],
@@ -20,6 +20,10 @@
 
 #include "common.h"
 
+#if defined(GPR_USE_OPENMP)
+#include <omp.h>
+#endif
+
 /*!
 	@brief Table of prescale values for the spatial wavelet transform
 
@@ -33,6 +37,152 @@
 */
 const int spatial_prescale[] = {0, 2, 0, 0, 0, 0, 0, 0};
 
+/*!
+	@brief Entry in the pool of reusable band data allocations
+
+	The codec creates and destroys a wavelet tree for every channel of
+	every frame.  The band data blocks are large and frequently have the
+	same size from frame to frame, so freed blocks are parked in a small
+	pool and claimed by the next allocation of the same size instead of
+	going back to the allocator.  The pool records the callback that
+	would have freed each block so that @ref FlushWaveletPool can release
+	the entries at codec shutdown.
+
+	The pool is kept in thread local storage instead of behind a lock:
+	codec instances on different threads get disjoint pools, and entries
+	record the free callback of the allocator that created them, so a
+	block is only reclaimed by an instance using the same allocator and
+	is always released through the callback that owns it.  A flush frees
+	only blocks parked on the calling thread (parked blocks are idle, so
+	flushing while a sibling instance is live is safe, it just empties
+	the shared pool early).
+*/
+typedef struct _wavelet_pool_entry
+{
+	void *memory;		//!< Base of the allocation (unaligned)
+	size_t size;		//!< Size of the allocation (in bytes)
+	gpr_free Free;		//!< Callback that frees the allocation
+
+} WAVELET_POOL_ENTRY;
+
+// Thread local storage keeps the pool private to each codec thread
+// (builds without thread local support do not pool at all)
+#if defined(_MSC_VER)
+#define WAVELET_POOL_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define WAVELET_POOL_THREAD_LOCAL __thread
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define WAVELET_POOL_THREAD_LOCAL _Thread_local
+#endif
+
+#if defined(WAVELET_POOL_THREAD_LOCAL)
+
+//! Maximum number of band data allocations parked in the pool
+#define WAVELET_POOL_CAPACITY 16
+
+//! Pool of band data allocations that can be reused
+static WAVELET_POOL_THREAD_LOCAL WAVELET_POOL_ENTRY wavelet_pool[WAVELET_POOL_CAPACITY];
+
+//! Number of allocations in the pool
+static WAVELET_POOL_THREAD_LOCAL int wavelet_pool_count = 0;
+
+/*!
+	@brief Claim a pooled allocation with the specified size
+
+	Only entries parked by an allocator with the same free callback are
+	claimed, so pooled blocks never migrate between allocators.
+
+	@return The base of the allocation or NULL if no pooled allocation
+	has the requested size.
+*/
+static void *ClaimPooledWaveletMemory(const gpr_allocator *allocator, size_t size)
+{
+	int i;
+
+	for (i = 0; i < wavelet_pool_count; i++)
+	{
+		if (wavelet_pool[i].size == size && wavelet_pool[i].Free == allocator->Free)
+		{
+			void *memory = wavelet_pool[i].memory;
+
+			// Fill the vacated slot with the last entry
+			wavelet_pool[i] = wavelet_pool[--wavelet_pool_count];
+
+			return memory;
+		}
+	}
+
+	return NULL;
+}
+
+/*!
+	@brief Park an allocation in the pool for reuse
+
+	@return true if the pool took ownership of the allocation.
+*/
+static bool ParkPooledWaveletMemory(const gpr_allocator *allocator, void *memory, size_t size)
+{
+	if (wavelet_pool_count < WAVELET_POOL_CAPACITY)
+	{
+		wavelet_pool[wavelet_pool_count].memory = memory;
+		wavelet_pool[wavelet_pool_count].size = size;
+		wavelet_pool[wavelet_pool_count].Free = allocator->Free;
+		wavelet_pool_count++;
+		return true;
+	}
+
+	return false;
+}
+
+/*!
+	@brief Free the band data allocations parked in the pool
+
+	This routine should be called when the codec is released so that the
+	pooled allocations do not outlive the decoder or encoder.  Only the
+	calling thread's pool is flushed; each block is released through the
+	free callback that was recorded when it was parked.
+*/
+CODEC_ERROR FlushWaveletPool(void)
+{
+	int i;
+
+	for (i = 0; i < wavelet_pool_count; i++)
+	{
+		wavelet_pool[i].Free(wavelet_pool[i].memory);
+	}
+
+	wavelet_pool_count = 0;
+
+	return CODEC_ERROR_OKAY;
+}
+
+#else
+
+// Without thread local storage the pool cannot be kept private to a
+// codec thread, so band data allocations are not pooled at all
+
+static void *ClaimPooledWaveletMemory(const gpr_allocator *allocator, size_t size)
+{
+	(void)allocator;
+	(void)size;
+	return NULL;
+}
+
+static bool ParkPooledWaveletMemory(const gpr_allocator *allocator, void *memory, size_t size)
+{
+	(void)allocator;
+	(void)memory;
+	(void)size;
+	return false;
+}
+
+CODEC_ERROR FlushWaveletPool(void)
+{
+	return CODEC_ERROR_OKAY;
+}
+
+#endif
+
 /*!
 	@brief Initialize a wavelet data structure with the specified dimensions
 */
@@ -43,11 +193,14 @@ CODEC_ERROR InitWavelet(WAVELET *wavelet, DIMENSION width, DIMENSION height)
 		return CODEC_ERROR_NULLPTR;
 	}
 
-	memset(wavelet, 0, sizeof(WAVELET));
-
-	wavelet->width = width;
-	wavelet->height = height;
-	wavelet->band_count = 4;
+	// The compound literal zero-initializes the remaining members and lets
+	// the compiler fuse the zeroing with the field assignments
+	*wavelet = (WAVELET) {
+		.width = width,
+		.height = height,
+		.band_count = 4,
+		.all_bands_mask = (1 << 4) - 1,
+	};
 
 	return CODEC_ERROR_OKAY;
 }
@@ -64,25 +217,42 @@ CODEC_ERROR AllocWavelet(gpr_allocator *allocator, WAVELET *wavelet, DIMENSION w
 	{
 		int band;
 
-		//TODO: Align the pitch?
-		DIMENSION pitch = width * sizeof(PIXEL);
+		// Round the pitch up to a multiple of the cache line size so that
+		// every row and every band starts on a 64-byte boundary (SIMD
+		// kernels downstream can then use aligned loads and stores)
+		DIMENSION pitch = (DIMENSION)((width * sizeof(PIXEL) + 63) & ~(size_t)63);
+
+		size_t band_stride = (size_t)height * pitch;
+
+		// Allocate extra space so that the first band can be aligned
+		size_t memory_size = band_stride * MAX_BAND_COUNT + 63;
 
-		size_t band_data_size = height * pitch;
-        
-        PIXEL* data_all_bands = (PIXEL *)allocator->Alloc(band_data_size * MAX_BAND_COUNT);
+		uint8_t *data_all_bands;
 
-        if ( data_all_bands == NULL )
+		// Reuse a pooled allocation of the same size if one is available
+		uint8_t *memory = (uint8_t *)ClaimPooledWaveletMemory(allocator, memory_size);
+
+		if (memory == NULL)
+		{
+			memory = (uint8_t *)allocator->Alloc(memory_size);
+		}
+
+        if ( memory == NULL )
         {
-            ReleaseWavelet(allocator, wavelet);
+            // InitWavelet left the wavelet with no resources to release
             return CODEC_ERROR_OUTOFMEMORY;
         }
-        
-		// Allocate the wavelet bands
+
+		data_all_bands = (uint8_t *)(((uintptr_t)memory + 63) & ~(uintptr_t)63);
+
+		// Assign the wavelet bands within the aligned block
 		for (band = 0; band < MAX_BAND_COUNT; band++)
 		{
-			wavelet->data[band] = data_all_bands + band * height * width;
+			wavelet->data[band] = (PIXEL *)(data_all_bands + band * band_stride);
 		}
 
+		wavelet->memory = memory;
+		wavelet->memory_size = memory_size;
 		wavelet->pitch = pitch;
 	}
 
@@ -98,9 +268,17 @@ CODEC_ERROR ReleaseWavelet(gpr_allocator *allocator, WAVELET *wavelet)
 {
 	int band;
 
-    PIXEL* data_all_bands = wavelet->data[0];
-    
-    allocator->Free(data_all_bands);
+	if (wavelet->memory != NULL)
+	{
+		// Park the allocation in the pool for reuse if there is room
+		if (! ParkPooledWaveletMemory(allocator, wavelet->memory, wavelet->memory_size))
+		{
+			allocator->Free(wavelet->memory);
+		}
+	}
+
+	wavelet->memory = NULL;
+	wavelet->memory_size = 0;
 
     for (band = 0; band < MAX_BAND_COUNT; band++) {
 		wavelet->data[band] = NULL;
@@ -161,90 +339,37 @@ CODEC_ERROR DeleteWavelet(gpr_allocator *allocator, WAVELET *wavelet)
 */
 CODEC_ERROR SetTransformScale(TRANSFORM *transform)
 {
-	//int num_wavelets = 3;
-	int num_spatial = 2;
+	// Number of wavelets in the transform (one frame wavelet followed by
+	// the spatial wavelets)
+	const int num_wavelets = MAX_WAVELET_COUNT;
 
-    int num_lowpass_spatial;	// Number of spatial transforms for lowpass temporal band
-	//int num_highpass_spatial;	// Number of spatial transforms for highpass temporal band
-	int num_frame_wavelets;		// Number of frame wavelets at the base of the pyramid
-
-	// Area of the temporal lowpass filter
-	int temporal_lowpass_area = 2;
-
-	// Area of the each wavelet filter
-	int horizontal_lowpass_area = 2;
-	int vertical_lowpass_area = 2;
-
-	// Combination of the horizontal and vertical wavelet transforms
-	int spatial_lowpass_area = (horizontal_lowpass_area * vertical_lowpass_area);
-
-	int temporal_lowpass_scale;
-	int temporal_highpass_scale;
-
-	WAVELET *wavelet = NULL;
-	//WAVELET *temporal;
+	// Cumulative scale of the lowpass band that is input to each wavelet
+	int temporal_lowpass_scale = 1;
 
 	int k;
-	int i;
 
-	// Coefficients in each band are scaled by the forward wavelet filters
-	int scale[4] = {1, 1, 1, 1};
-
-    // Compute the number of frame and spatial wavelets
-    num_frame_wavelets = 1;
-    num_lowpass_spatial = num_spatial;
-
-    // Compute the change in scale due to the filters used in the frame transform
-    temporal_lowpass_scale = temporal_lowpass_area * scale[0];
-    temporal_highpass_scale = scale[0];
-
-    // Compute the scale factors for the first wavelet
-    scale[0] = horizontal_lowpass_area * temporal_lowpass_scale;
-    scale[1] = temporal_lowpass_scale;
-    scale[2] = horizontal_lowpass_area * temporal_highpass_scale;
-    scale[3] = temporal_highpass_scale;
-
-    for (k = 0; k < num_frame_wavelets; k++)
-    {
-        wavelet = transform->wavelet[k];
-        assert(wavelet != NULL);
-        if (! (wavelet != NULL)) {
-            return CODEC_ERROR_UNEXPECTED;
-        }
-
-        wavelet->scale[0] = scale[0];
-        wavelet->scale[1] = scale[1];
-        wavelet->scale[2] = scale[2];
-        wavelet->scale[3] = scale[3];
-    }
-
-    // Compute the scale factors for the spatial wavelets
-    for (i = 0; i < num_lowpass_spatial; i++)
-    {
-        WAVELET *spatial = transform->wavelet[k++];
-        //int k;
-
-        assert(spatial != NULL);
-        if (! (spatial != NULL)) {
-            return CODEC_ERROR_UNEXPECTED;
-        }
-        
-        assert(wavelet != NULL);
-        if (! (wavelet != NULL)) {
-            return CODEC_ERROR_UNEXPECTED;
-        }
+	// Each wavelet level scales the lowpass input by the four pixel area of
+	// the combined horizontal and vertical lowpass filters, the two highpass
+	// intermediate bands by the two pixel area of a single lowpass filter,
+	// and leaves the highpass band unscaled.  The filter areas are powers of
+	// two so the multiplications reduce to shifts.
+	for (k = 0; k < num_wavelets; k++)
+	{
+		WAVELET *wavelet = transform->wavelet[k];
 
-        // The lowpass band is the input to the spatial transform
-        temporal_lowpass_scale = wavelet->scale[0];
+		assert(wavelet != NULL);
+		if (! (wavelet != NULL)) {
+			return CODEC_ERROR_UNEXPECTED;
+		}
 
-        spatial->scale[0] = (spatial_lowpass_area * temporal_lowpass_scale);// >> _LOWPASS_PRESCALE;
-        spatial->scale[1] = (vertical_lowpass_area * temporal_lowpass_scale);// >> _LOWPASS_PRESCALE;
-        spatial->scale[2] = (horizontal_lowpass_area * temporal_lowpass_scale);// >> _LOWPASS_PRESCALE;
-        spatial->scale[3] = (temporal_lowpass_scale);// >> _LOWPASS_PRESCALE;
+		wavelet->scale[0] = (temporal_lowpass_scale << 2);
+		wavelet->scale[1] = (temporal_lowpass_scale << 1);
+		wavelet->scale[2] = (temporal_lowpass_scale << 1);
+		wavelet->scale[3] = temporal_lowpass_scale;
 
-        // The spatial wavelet is the input for the next level
-        wavelet = spatial;
-    }
+		// The lowpass band is the input to the next wavelet level
+		temporal_lowpass_scale = wavelet->scale[0];
+	}
 
 	return CODEC_ERROR_OKAY;
 }
@@ -258,21 +383,20 @@ CODEC_ERROR SetTransformScale(TRANSFORM *transform)
 */
 CODEC_ERROR SetTransformPrescale(TRANSFORM *transform, int precision)
 {
+	// Prescale values for each encoded precision (frame, spatial, spatial, ...)
+	// The tables are at file scope so they are not rebuilt on the stack
+	// every call and the copies compile down to a pair of stores
+	static const PRESCALE prescale_zero[MAX_PRESCALE_COUNT]    = {0, 0, 0, 0, 0, 0, 0, 0};
+	static const PRESCALE prescale_spatial[MAX_PRESCALE_COUNT] = {0, 2, 2, 0, 0, 0, 0, 0};
+
 	if (precision == 8)
 	{
-		memset(transform->prescale, 0, sizeof(transform->prescale));
+		memcpy(transform->prescale, prescale_zero, sizeof(transform->prescale));
 		return CODEC_ERROR_OKAY;
 	}
-	else if (precision == 10)
-	{
-		PRESCALE spatial_prescale[]  = {0, 2, 2, 0, 0, 0, 0, 0};
-		memcpy(transform->prescale, spatial_prescale, sizeof(transform->prescale));
-	}
-	else if (precision == 12)
+	else if (precision == 10 || precision == 12)
 	{
-		// frame, spatial, spatial, ...
-		PRESCALE spatial_prescale[]  = {0, 2, 2, 0, 0, 0, 0, 0};
-		memcpy(transform->prescale, spatial_prescale, sizeof(transform->prescale));
+		memcpy(transform->prescale, prescale_spatial, sizeof(transform->prescale));
 	}
 	else
 	{
@@ -283,87 +407,6 @@ CODEC_ERROR SetTransformPrescale(TRANSFORM *transform, int precision)
 	return CODEC_ERROR_OKAY;
 }
 
-/*!
-	@brief Return a mask for the specified wavelet band
-
-	The wavelet data structure contains a mask that indicates which
-	bands have been decoded.
-*/
-bool BandValidMask(int band)
-{
-	return (1 << band);
-}
-
-/*!
-	@brief Check that all bands are valid
-
-	The wavelet valid band mask is checked to determine whether
-	all of the bands in the wavelet have been decoded.
-*/
-bool BandsAllValid(WAVELET *wavelet)
-{
-	uint32_t all_bands_valid_mask = ((1 << wavelet->band_count) - 1);
-	return (wavelet->valid_band_mask == all_bands_valid_mask);
-}
-
-/*!
-	@brief Set the bit for the specified band in the valid band mask
-*/
-CODEC_ERROR UpdateWaveletValidBandMask(WAVELET *wavelet, int band)
-{
-	if (0 <= band && band < MAX_BAND_COUNT)
-	{
-		// Update the valid wavelet band flags
-		wavelet->valid_band_mask |= (1 << band);
-		return CODEC_ERROR_OKAY;
-	}
-	return CODEC_ERROR_INVALID_BAND;
-}
-
-/*!
-	@brief Compute the wavelet index from the subband index
-
-	All subbands that are encoded into the bitstream, including the
-	lowpass band at the highest wavelet level, are numbered in decode
-	order starting with zero for the lowpass band.
-
-	This routine maps the subband index to the index of the wavelet
-	that contains the specified subband.
-
-	Note the sifference between a wavelet band and a subband: The bands in
-	each wavelet are numbered starting at zero, while the subband index
-	applies to all wavelet bands in the encoded sample and does not include
-	the lowpass bands that are reconstructed during decoding from the bands
-	that were encoded into the bitstream.
-*/
-int SubbandWaveletIndex(int subband)
-{
-	//TODO: Adjust for other transform types and decoded resolutions
-	static int subband_wavelet_index[] = {2, 2, 2, 2, 1, 1, 1, 0, 0, 0};
-
-	assert(0 <= subband && subband < MAX_SUBBAND_COUNT);
-
-	// Return the index of the wavelet corresponding to this subband
-	return subband_wavelet_index[subband];
-}
-
-/*!
-	@brief Compute the index for the band in a wavelet from the subband index
-
-	See the explanation of wavelet bands and subbands in the documentation for
-	@ref SubbandWaveletIndex.
-*/
-int SubbandBandIndex(int subband)
-{
-	//TODO: Adjust for other transform types and decoded resolutions
-	static int subband_band_index[] = {0, 1, 2, 3, 1, 2, 3, 1, 2, 3};
-
-	assert(0 <= subband && subband < MAX_SUBBAND_COUNT);
-
-	// Return the index to the band within the wavelet
-	return subband_band_index[subband];
-}
-
 /*!
 	@brief Free the wavelets allocated for this transform
 */
@@ -394,24 +437,27 @@ CODEC_ERROR ReleaseTransform(gpr_allocator *allocator, TRANSFORM *transform)
 bool IsTransformPrescaleDefault(TRANSFORM *transform, int precision)
 {
 	int prescale_count = sizeof(transform->prescale) / sizeof(transform->prescale[0]);
-	int total = 0;
+	uint32_t diff = 0;
 	int i;
 
+	// Only whether any value differs matters, so the differences are
+	// OR-accumulated instead of summing absolute values, which removes
+	// the branches from the loop body
 	if (precision == 8)
 	{
 		for (i = 0; i < prescale_count; i++) {
-			total += transform->prescale[i];
+			diff |= transform->prescale[i];
 		}
-		return (total == 0);
+		return (diff == 0);
 	}
     
     for (i = 0; i < prescale_count; i++) {
-        total += absolute(transform->prescale[i] - spatial_prescale[i]);
+        diff |= (uint32_t)(transform->prescale[i] ^ spatial_prescale[i]);
     }
     for(; i < MAX_PRESCALE_COUNT; i++) {
-        total += spatial_prescale[i];
+        diff |= (uint32_t)spatial_prescale[i];
     }
-    return (total == 0);
+    return (diff == 0);
 }
 
 PIXEL *WaveletRowAddress(WAVELET *wavelet, int band, int row)
@@ -434,6 +480,176 @@ PIXEL *WaveletRowAddress(WAVELET *wavelet, int band, int row)
 	}
 }
 
+/*!
+	@brief Clamp a value to the range of a log curve table index
+
+	Pure bitwise form of @ref clamp_uint for the 12-bit table index: the
+	sign mask zeroes negative values and the overflow mask saturates
+	values above 4095, so the common in-range path executes straight-line
+	arithmetic with no compares the branch predictor can miss.
+*/
+STATIC_INLINE int32_t ClampIndex12(int32_t value)
+{
+	int32_t over;
+
+	// Zero the value if it is negative
+	value &= ~(value >> 31);
+
+	// Saturate the value if it exceeds the table range
+	over = ((LOG_CURVE_TABLE_LENGTH - 1) - value) >> 31;
+
+	return (value & ~over) | ((LOG_CURVE_TABLE_LENGTH - 1) & over);
+}
+
+#if VC5_HAVE_AVX2
+
+#include <immintrin.h>
+
+/*!
+	@brief Convert one row of wavelet components to RGB using AVX2 (eight pixels per pass)
+
+	The sources are read in reversed order, so each pass loads eight
+	consecutive components ending at the current position and reverses the
+	lanes.  The log curve lookups use vector gathers and the square root in
+	the 8-bit path runs eight lanes wide.  The remainder of the row is
+	handled by the scalar loop in @ref WaveletToRGB.
+
+	@return The number of pixels converted (a multiple of eight).
+*/
+VC5_TARGET_AVX2
+static DIMENSION WaveletToRGBRow_AVX2(const PIXEL *GS_row, const PIXEL *RG_row, const PIXEL *BG_row,
+									  DIMENSION src_width, uint8_t *dst8, uint16_t *dst16,
+									  int32_t midpoint, int32_t shift, int output_precision_bits,
+									  gpr_rgb_gain *rgb_gain)
+{
+	const __m256i zero_epi32 = _mm256_setzero_si256();
+	const __m256i max12_epi32 = _mm256_set1_epi32((1 << 12) - 1);
+	const __m256i mask16_epi32 = _mm256_set1_epi32(0xFFFF);
+	const __m256i midpoint_epi32 = _mm256_set1_epi32(midpoint);
+
+	// Reverse the order of eight 16-bit lanes
+	const __m128i reverse_epi16 = _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+
+	const DIMENSION vector_width = (DIMENSION)(src_width & ~7);
+	DIMENSION x;
+
+	for (x = 0; x < vector_width; x += 8)
+	{
+		// Load eight components ending at the current reversed position
+		const int offset = src_width - x - 8;
+
+		// Fetch a cache line ahead of the descending source reads
+		__builtin_prefetch(GS_row + offset - 32, 0, 0);
+		__builtin_prefetch(RG_row + offset - 32, 0, 0);
+		__builtin_prefetch(BG_row + offset - 32, 0, 0);
+		__m128i gs = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(GS_row + offset)), reverse_epi16);
+		__m128i rg = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(RG_row + offset)), reverse_epi16);
+		__m128i bg = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(BG_row + offset)), reverse_epi16);
+
+		__m256i G = _mm256_cvtepi16_epi32(gs);
+		__m256i R = _mm256_add_epi32(_mm256_slli_epi32(_mm256_sub_epi32(_mm256_cvtepi16_epi32(rg), midpoint_epi32), 1), G);
+		__m256i B = _mm256_add_epi32(_mm256_slli_epi32(_mm256_sub_epi32(_mm256_cvtepi16_epi32(bg), midpoint_epi32), 1), G);
+
+		// Clamp the shifted values to 12 bits and look up the log curve
+		R = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(R, shift), zero_epi32), max12_epi32);
+		G = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(G, shift), zero_epi32), max12_epi32);
+		B = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(B, shift), zero_epi32), max12_epi32);
+
+		R = _mm256_and_si256(_mm256_i32gather_epi32((const int *)DecoderLogCurve, R, 2), mask16_epi32);
+		G = _mm256_and_si256(_mm256_i32gather_epi32((const int *)DecoderLogCurve, G, 2), mask16_epi32);
+		B = _mm256_and_si256(_mm256_i32gather_epi32((const int *)DecoderLogCurve, B, 2), mask16_epi32);
+
+		if (output_precision_bits == 8)
+		{
+			__m256i bytes;
+			__m128i lo, hi, out0, out1;
+
+			// Byte shuffles that interleave [R0-7, B0-7] and [G0-7, B0-7]
+			// into the RGB output sequence (24 bytes for eight pixels)
+			const __m128i interleave8_lo0 = _mm_setr_epi8(0, -1, 8, 1, -1, 9, 2, -1, 10, 3, -1, 11, 4, -1, 12, 5);
+			const __m128i interleave8_hi0 = _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1);
+			const __m128i interleave8_lo1 = _mm_setr_epi8(-1, 13, 6, -1, 14, 7, -1, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+			const __m128i interleave8_hi1 = _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+			// Apply the gains and the square root eight lanes at a time
+			R = _mm256_mullo_epi32(R, _mm256_set1_epi32(rgb_gain->r_gain_num));
+			G = _mm256_mullo_epi32(G, _mm256_set1_epi32(rgb_gain->g_gain_num));
+			B = _mm256_mullo_epi32(B, _mm256_set1_epi32(rgb_gain->b_gain_num));
+
+			R = _mm256_srl_epi32(R, _mm_cvtsi32_si128(rgb_gain->r_gain_pow2_den));
+			G = _mm256_srl_epi32(G, _mm_cvtsi32_si128(rgb_gain->g_gain_pow2_den));
+			B = _mm256_srl_epi32(B, _mm_cvtsi32_si128(rgb_gain->b_gain_pow2_den));
+
+			R = _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(R)));
+			G = _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(G)));
+			B = _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(B)));
+
+			R = _mm256_min_epi32(_mm256_max_epi32(R, zero_epi32), _mm256_set1_epi32(255));
+			G = _mm256_min_epi32(_mm256_max_epi32(G, zero_epi32), _mm256_set1_epi32(255));
+			B = _mm256_min_epi32(_mm256_max_epi32(B, zero_epi32), _mm256_set1_epi32(255));
+
+			// Pack the three planes to bytes: the low half holds [R0-7, B0-7]
+			// and the high half holds [G0-7, B0-7]
+			bytes = _mm256_packus_epi16(
+				_mm256_permute4x64_epi64(_mm256_packus_epi32(R, G), 0xD8),
+				_mm256_permute4x64_epi64(_mm256_packus_epi32(B, B), 0xD8));
+			lo = _mm256_castsi256_si128(bytes);
+			hi = _mm256_extracti128_si256(bytes, 1);
+
+			// Interleave the planes into RGB triples and store exactly
+			// 24 bytes so the last pass cannot write past the row
+			out0 = _mm_or_si128(_mm_shuffle_epi8(lo, interleave8_lo0), _mm_shuffle_epi8(hi, interleave8_hi0));
+			out1 = _mm_or_si128(_mm_shuffle_epi8(lo, interleave8_lo1), _mm_shuffle_epi8(hi, interleave8_hi1));
+			_mm_storeu_si128((__m128i *)dst8, out0);
+			_mm_storel_epi64((__m128i *)(dst8 + 16), out1);
+			dst8 += 24;
+		}
+		else
+		{
+			__m128i r16, g16, b16, out0, out1, out2;
+
+			// Byte shuffles that interleave the three 16-bit planes into the
+			// RGB output sequence and swap the bytes of every component in
+			// the same pass (48 bytes for eight pixels)
+			const __m128i interleave16_r0 = _mm_setr_epi8(1, 0, -1, -1, -1, -1, 3, 2, -1, -1, -1, -1, 5, 4, -1, -1);
+			const __m128i interleave16_g0 = _mm_setr_epi8(-1, -1, 1, 0, -1, -1, -1, -1, 3, 2, -1, -1, -1, -1, 5, 4);
+			const __m128i interleave16_b0 = _mm_setr_epi8(-1, -1, -1, -1, 1, 0, -1, -1, -1, -1, 3, 2, -1, -1, -1, -1);
+			const __m128i interleave16_r1 = _mm_setr_epi8(-1, -1, 7, 6, -1, -1, -1, -1, 9, 8, -1, -1, -1, -1, 11, 10);
+			const __m128i interleave16_g1 = _mm_setr_epi8(-1, -1, -1, -1, 7, 6, -1, -1, -1, -1, 9, 8, -1, -1, -1, -1);
+			const __m128i interleave16_b1 = _mm_setr_epi8(5, 4, -1, -1, -1, -1, 7, 6, -1, -1, -1, -1, 9, 8, -1, -1);
+			const __m128i interleave16_r2 = _mm_setr_epi8(-1, -1, -1, -1, 13, 12, -1, -1, -1, -1, 15, 14, -1, -1, -1, -1);
+			const __m128i interleave16_g2 = _mm_setr_epi8(11, 10, -1, -1, -1, -1, 13, 12, -1, -1, -1, -1, 15, 14, -1, -1);
+			const __m128i interleave16_b2 = _mm_setr_epi8(-1, -1, 11, 10, -1, -1, -1, -1, 13, 12, -1, -1, -1, -1, 15, 14);
+
+			// Pack the 16-bit log curve outputs down from the gather lanes
+			r16 = _mm_packus_epi32(_mm256_castsi256_si128(R), _mm256_extracti128_si256(R, 1));
+			g16 = _mm_packus_epi32(_mm256_castsi256_si128(G), _mm256_extracti128_si256(G, 1));
+			b16 = _mm_packus_epi32(_mm256_castsi256_si128(B), _mm256_extracti128_si256(B, 1));
+
+			// Interleave the planes into RGB triples with the byte swap
+			// folded into the shuffle masks
+			out0 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r16, interleave16_r0),
+											 _mm_shuffle_epi8(g16, interleave16_g0)),
+								_mm_shuffle_epi8(b16, interleave16_b0));
+			out1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r16, interleave16_r1),
+											 _mm_shuffle_epi8(g16, interleave16_g1)),
+								_mm_shuffle_epi8(b16, interleave16_b1));
+			out2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r16, interleave16_r2),
+											 _mm_shuffle_epi8(g16, interleave16_g2)),
+								_mm_shuffle_epi8(b16, interleave16_b2));
+
+			_mm_storeu_si128((__m128i *)(dst16 + 0), out0);
+			_mm_storeu_si128((__m128i *)(dst16 + 8), out1);
+			_mm_storeu_si128((__m128i *)(dst16 + 16), out2);
+			dst16 += 24;
+		}
+	}
+
+	return vector_width;
+}
+
+#endif // VC5_HAVE_AVX2
+
 void WaveletToRGB( gpr_allocator allocator, PIXEL* GS_src, PIXEL* RG_src, PIXEL* BG_src, DIMENSION src_width, DIMENSION src_height, DIMENSION src_pitch, RGB_IMAGE *dst_image,
                    int input_precision_bits, int output_precision_bits, gpr_rgb_gain* rgb_gain  )
 {
@@ -464,53 +680,118 @@ void WaveletToRGB( gpr_allocator allocator, PIXEL* GS_src, PIXEL* RG_src, PIXEL*
     unsigned char*  RGB_dst_8bits  = dst_image->buffer;
     unsigned short* RGB_dst_16bits = dst_image->buffer;
     
-    DIMENSION x, y;
+    // Fold the log curve, the gains, the square root and the output clamp
+    // (8-bit path) or the log curve and the byte swap (16-bit path) into a
+    // single table keyed on the clamped 12-bit input.  Building the tables
+    // costs 4096 entries per channel once per call and removes the
+    // multiply, shift, square root and clamp from every pixel.
+    uint8_t  lut_r8[LOG_CURVE_TABLE_LENGTH];
+    uint8_t  lut_g8[LOG_CURVE_TABLE_LENGTH];
+    uint8_t  lut_b8[LOG_CURVE_TABLE_LENGTH];
+    uint16_t lut_16[LOG_CURVE_TABLE_LENGTH];
+
+    if( output_precision_bits == 8 )
+    {
+        int i;
+        for (i = 0; i < LOG_CURVE_TABLE_LENGTH; i++)
+        {
+            int32_t value = DecoderLogCurve[i];
+            lut_r8[i] = clamp_uint8( (int32_t)sqrtf( (float)((value * rgb_gain->r_gain_num) >> rgb_gain->r_gain_pow2_den) ) );
+            lut_g8[i] = clamp_uint8( (int32_t)sqrtf( (float)((value * rgb_gain->g_gain_num) >> rgb_gain->g_gain_pow2_den) ) );
+            lut_b8[i] = clamp_uint8( (int32_t)sqrtf( (float)((value * rgb_gain->b_gain_num) >> rgb_gain->b_gain_pow2_den) ) );
+        }
+    }
+    else
+    {
+        int i;
+        for (i = 0; i < LOG_CURVE_TABLE_LENGTH; i++)
+        {
+            lut_16[i] = Swap16(DecoderLogCurve[i]);
+        }
+    }
     
-    for ( y = 0; y < src_height; y++)
+    // Rows are independent (the destination writes for each row are disjoint)
+    // so the row loop can be distributed across cores when OpenMP is enabled
+#if defined(GPR_USE_OPENMP)
+    #pragma omp parallel for schedule(static) if (src_height >= 32)
+#endif
+    for ( int y = 0; y < (int)src_height; y++)
     {
-        for ( x = 0;  x < src_width; x++)
+        DIMENSION x;
+        DIMENSION x_start = 0;
+
+#if VC5_HAVE_AVX2
+        // Convert as much of the row as possible eight pixels at a time
+        if (CpuHasAVX2())
+        {
+            x_start = WaveletToRGBRow_AVX2(GS_src + y * src_pitch, RG_src + y * src_pitch, BG_src + y * src_pitch,
+                                           src_width, RGB_dst_8bits + y * dst_image->pitch,
+                                           RGB_dst_16bits + y * dst_image->pitch,
+                                           midpoint, shift, output_precision_bits, rgb_gain);
+        }
+#endif
+
+        // Walk a descending source pointer and an ascending destination
+        // pointer instead of recomputing the reversed index for each of the
+        // three components on every pixel
+        const PIXEL *gs = GS_src + y * src_pitch + (src_width - x_start - 1);
+        const PIXEL *rg = RG_src + y * src_pitch + (src_width - x_start - 1);
+        const PIXEL *bg = BG_src + y * src_pitch + (src_width - x_start - 1);
+
+        uint8_t  *dst8  = RGB_dst_8bits  + y * dst_image->pitch + 3 * x_start;
+        uint16_t *dst16 = RGB_dst_16bits + y * dst_image->pitch + 3 * x_start;
+
+        // The output precision is fixed for the whole image, so test it once
+        // and keep the per pixel loops free of the branch
+        if( output_precision_bits == 8 )
         {
-            int32_t G = GS_src[ (src_width - x - 1) + y * src_pitch];
-            int32_t R = 2 * ( RG_src[(src_width - x - 1) + y * src_pitch] - midpoint) + G;
-            int32_t B = 2 * ( BG_src[(src_width - x - 1) + y * src_pitch] - midpoint) + G;
-            
-            // R,G,B are in 16-bit range since DecoderLogCurve outputs in 16 bits (although it's input is 12 bits)
-            R = DecoderLogCurve[ clamp_uint( (R >> shift), 12) ];
-            G = DecoderLogCurve[ clamp_uint( (G >> shift), 12) ];
-            B = DecoderLogCurve[ clamp_uint( (B >> shift), 12) ];
-
-            if( output_precision_bits == 8 )
+            for ( x = x_start;  x < src_width; x++)
             {
-                R *= rgb_gain->r_gain_num;
-                R >>= rgb_gain->r_gain_pow2_den;
-
-                G *= rgb_gain->g_gain_num;
-                G >>= rgb_gain->g_gain_pow2_den;
-
-                B *= rgb_gain->b_gain_num;
-                B >>= rgb_gain->b_gain_pow2_den;
-                
-                R = sqrtf((float)R);
-                G = sqrtf((float)G);
-                B = sqrtf((float)B);
-                
-                R = clamp_uint8( R );
-                G = clamp_uint8( G );
-                B = clamp_uint8( B );
-                
-                RGB_dst_8bits[3 * (x) + 0 + y * dst_image->pitch] = R;
-                RGB_dst_8bits[3 * (x) + 1 + y * dst_image->pitch] = G;
-                RGB_dst_8bits[3 * (x) + 2 + y * dst_image->pitch] = B;
+#if defined(__GNUC__)
+                // The sources are read in descending order so the hardware
+                // prefetcher gets no hint; fetch a cache line ahead of each
+                // source and behind the destination (the rows are read and
+                // written once, so the lines are not expected to be reused)
+                __builtin_prefetch(gs - 32, 0, 0);
+                __builtin_prefetch(rg - 32, 0, 0);
+                __builtin_prefetch(bg - 32, 0, 0);
+                __builtin_prefetch(dst8 + 64, 1, 0);
+#endif
+                int32_t G = *(gs--);
+                int32_t R = 2 * ( *(rg--) - midpoint) + G;
+                int32_t B = 2 * ( *(bg--) - midpoint) + G;
+
+                R = ClampIndex12(R >> shift);
+                G = ClampIndex12(G >> shift);
+                B = ClampIndex12(B >> shift);
+
+                *(dst8++) = lut_r8[R];
+                *(dst8++) = lut_g8[G];
+                *(dst8++) = lut_b8[B];
             }
-            else
+        }
+        else
+        {
+            for ( x = x_start;  x < src_width; x++)
             {
-                R = clamp_uint16( R );
-                G = clamp_uint16( G );
-                B = clamp_uint16( B );
-
-                RGB_dst_16bits[3 * (x) + 0 + y * dst_image->pitch] = ( (R & 0x00FF) << 8 ) | ( (R & 0xFF00) >> 8 );
-                RGB_dst_16bits[3 * (x) + 1 + y * dst_image->pitch] = ( (G & 0x00FF) << 8 ) | ( (G & 0xFF00) >> 8 );
-                RGB_dst_16bits[3 * (x) + 2 + y * dst_image->pitch] = ( (B & 0x00FF) << 8 ) | ( (B & 0xFF00) >> 8 );
+#if defined(__GNUC__)
+                // See the prefetch rationale in the 8-bit loop above
+                __builtin_prefetch(gs - 32, 0, 0);
+                __builtin_prefetch(rg - 32, 0, 0);
+                __builtin_prefetch(bg - 32, 0, 0);
+                __builtin_prefetch(dst16 + 32, 1, 0);
+#endif
+                int32_t G = *(gs--);
+                int32_t R = 2 * ( *(rg--) - midpoint) + G;
+                int32_t B = 2 * ( *(bg--) - midpoint) + G;
+
+                R = ClampIndex12(R >> shift);
+                G = ClampIndex12(G >> shift);
+                B = ClampIndex12(B >> shift);
+
+                *(dst16++) = lut_16[R];
+                *(dst16++) = lut_16[G];
+                *(dst16++) = lut_16[B];
             }
         }
     }
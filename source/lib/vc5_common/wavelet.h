@@ -44,9 +44,13 @@ typedef struct _wavelet
 	DIMENSION pitch;					//!< Distance between rows (in bytes)
 	uint16_t band_count;				//!< Number of bands in a wavelet
 	uint32_t valid_band_mask;			//!< Mask indicating which bands have been decoded
+	uint32_t all_bands_mask;			//!< Valid band mask value when every band has been decoded
 	uint16_t scale[MAX_BAND_COUNT];		//!< Cumulative scaling by the wavelet transforms
 	QUANT quant[MAX_BAND_COUNT];		//!< Quantization value for each band
 	PIXEL *data[MAX_BAND_COUNT];		//!< Data buffer for each band
+
+	void *memory;						//!< Base of the allocation for the band data
+	size_t memory_size;					//!< Size of the allocation (in bytes)
     
 } WAVELET;
 
@@ -71,6 +75,105 @@ enum
 
 };
 
+/*!
+	@brief Table that maps a subband index to its wavelet and band
+
+	All subbands that are encoded into the bitstream, including the
+	lowpass band at the highest wavelet level, are numbered in decode
+	order starting with zero for the lowpass band.  The wavelet index
+	is packed into the high nibble of each entry and the band index
+	within that wavelet is packed into the low nibble, so both lookup
+	tables share a single run of sixteen bytes.  The table is padded to
+	sixteen entries with the lowpass wavelet and band so the masked
+	index can never read out of bounds, and the power of two size lets
+	the compiler keep the whole table in one aligned vector register.
+
+	//TODO: Adjust for other transform types and decoded resolutions
+*/
+static const uint8_t subband_info[16] = {
+	0x20, 0x21, 0x22, 0x23, 0x11, 0x12, 0x13, 0x01, 0x02, 0x03,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+/*!
+	@brief Compute the wavelet index from the subband index
+*/
+STATIC_INLINE int SubbandWaveletIndex(int subband)
+{
+	assert(0 <= subband && subband < MAX_SUBBAND_COUNT);
+
+	// Return the index of the wavelet corresponding to this subband
+	return (subband_info[subband & 0x0F] >> 4);
+}
+
+/*!
+	@brief Compute the index for the band in a wavelet from the subband index
+
+	See the explanation of wavelet bands and subbands in the documentation for
+	@ref SubbandWaveletIndex.
+*/
+STATIC_INLINE int SubbandBandIndex(int subband)
+{
+	assert(0 <= subband && subband < MAX_SUBBAND_COUNT);
+
+	// Return the index to the band within the wavelet
+	return (subband_info[subband & 0x0F] & 0x0F);
+}
+
+/*!
+	@brief Return a mask for the specified wavelet band
+
+	The wavelet data structure contains a mask that indicates which
+	bands have been decoded.  Note that the mask is returned as an
+	integer since a bool would truncate the mask for all but band zero.
+*/
+STATIC_INLINE uint32_t BandValidMask(int band)
+{
+	return ((uint32_t)1 << band);
+}
+
+/*!
+	@brief Check that all bands are valid
+
+	The wavelet valid band mask is checked to determine whether
+	all of the bands in the wavelet have been decoded.
+*/
+STATIC_INLINE bool BandsAllValid(const WAVELET *wavelet)
+{
+	return (wavelet->valid_band_mask == wavelet->all_bands_mask);
+}
+#define AllBandsValid BandsAllValid
+
+/*!
+	@brief Set the bit for the specified band in the valid band mask
+
+	The mask update is performed after every decoded band, so it is
+	defined inline alongside the validity checks that read the mask.
+*/
+STATIC_INLINE CODEC_ERROR UpdateWaveletValidBandMask(WAVELET *wavelet, int band)
+{
+	if (0 <= band && band < MAX_BAND_COUNT)
+	{
+		// Update the valid wavelet band flags
+		wavelet->valid_band_mask |= (1 << band);
+		return CODEC_ERROR_OKAY;
+	}
+	return CODEC_ERROR_INVALID_BAND;
+}
+
+/*!
+	@brief Mark the specified band valid and report whether the wavelet is ready
+
+	Fuses the valid band mask update with the all-bands check that always
+	follows it on the band decoding path, so the mask is loaded once and
+	the caller branches directly on the result.
+*/
+STATIC_INLINE bool MarkBandAndCheckReady(WAVELET *wavelet, int band)
+{
+	wavelet->valid_band_mask |= (1 << band);
+	return (wavelet->valid_band_mask == wavelet->all_bands_mask);
+}
+
 //! Data structure for the wavelet tree (one channel)
 typedef struct _transform
 {
@@ -90,6 +193,8 @@ extern "C" {
     CODEC_ERROR AllocWavelet(gpr_allocator *allocator, WAVELET *wavelet, DIMENSION width, DIMENSION height);
     CODEC_ERROR ReleaseWavelet(gpr_allocator *allocator, WAVELET *wavelet);
 
+    CODEC_ERROR FlushWaveletPool(void);
+
     WAVELET *CreateWavelet(gpr_allocator *allocator, DIMENSION width, DIMENSION height);
     CODEC_ERROR DeleteWavelet(gpr_allocator *allocator, WAVELET *wavelet);
 
@@ -97,17 +202,6 @@ extern "C" {
 
     CODEC_ERROR SetTransformPrescale(TRANSFORM *transform, int precision);
 
-    bool BandValidMask(int band);
-
-    bool BandsAllValid(WAVELET *wavelet);
-    #define AllBandsValid BandsAllValid
-
-    CODEC_ERROR UpdateWaveletValidBandMask(WAVELET *wavelet, int band);
-
-    int SubbandWaveletIndex(int subband);
-
-    int SubbandBandIndex(int subband);
-
     CODEC_ERROR ResetTransformFlags(TRANSFORM transform[], int transform_count);
 
     CODEC_ERROR ReleaseTransform(gpr_allocator *allocator, TRANSFORM *transform);
@@ -29,7 +29,7 @@
 	Codebook #17 is intended to be used with cubic companding
 	(see @ref FillMagnitudeEncodingTable and @ref ComputeCubicTable).
  */
-DECODER_CODESET decoder_codeset_17 = {
+const DECODER_CODESET decoder_codeset_17 = {
     "Codebook set 17 from data by David Newman with tables automatically generated for the FSM decoder",
     (const CODEBOOK *)&table17,
     CODESET_FLAGS_COMPANDING_CUBIC,
@@ -41,7 +41,7 @@ extern "C" {
     } DECODER_CODESET;
     
     //TODO: Need to support other codesets in the reference decoder?
-    extern DECODER_CODESET decoder_codeset_17;
+    extern const DECODER_CODESET decoder_codeset_17;
 
 #ifdef __cplusplus
 }
@@ -20,92 +20,254 @@
 
 #include "headers.h"
 
-CODEC_ERROR ParseInverseComponentTransform(DECODER *decoder, BITSTREAM *stream, size_t chunk_size)
+// Forward reference
+static int InverseComponentCount(DECODER *decoder);
+
+//! Payload size of the inverse component transform chunk in bytes for each
+//! component count (entry N is (N + 2) * N), so the payload computation is a
+//! single table load instead of a multiply
+static const uint16_t ict_payload_bytes[MAX_COMPONENT_COUNT + 1] = {
+    0, 3, 8, 15, 24, 35, 48, 63, 80,
+};
+
+/*!
+	@brief Cache the payload sizes of the inverse component chunks
+
+	The payload sizes depend only on the component count, which is fixed
+	once the channel count and pattern dimensions have been parsed from
+	the bitstream header, so the sizes are computed when those parameters
+	change instead of on every chunk parse.
+*/
+void UpdateInverseComponentPayloadSizes(DECODER *decoder)
+{
+    int component_count = InverseComponentCount(decoder);
+
+    // Component counts beyond the table are rejected by the chunk parsers,
+    // so the index is clamped only to keep the table lookup in bounds
+    int index = (component_count <= MAX_COMPONENT_COUNT) ? component_count : MAX_COMPONENT_COUNT;
+
+    // The transform payload is the matrix in row-major order with the
+    // offset and scale appended to each row
+    decoder->inverse_transform_payload = (size_t)ict_payload_bytes[index];
+    decoder->inverse_permutation_payload = (size_t)component_count;
+}
+
+/*!
+	@brief Return the number of components in the inverse component transform
+
+	The component count normally equals the channel count, but when the
+	color sampling part is enabled it is derived from the dimensions of
+	the color difference pattern.  The computation is hoisted out of the
+	chunk parsers so the branch on the enabled parts is evaluated once
+	per call and the parsers share one definition.
+*/
+static int InverseComponentCount(DECODER *decoder)
 {
-    //CODEC_ERROR error = CODEC_ERROR_OKAY;
     CODEC_STATE *codec = &decoder->codec;
     int component_count = codec->channel_count;
-    int padding;
-    int i;
-    
+
 #if VC5_ENABLED_PART(VC5_PART_COLOR_SAMPLING)
     if (IsPartEnabled(decoder->enabled_parts, VC5_PART_COLOR_SAMPLING))
     {
-        // Recompute the number of components to account for color difference component subsampling
-        component_count = codec->pattern_width * codec->pattern_height + 2;
+        // The component count for color difference component subsampling is
+        // cached when the pattern dimensions are parsed from the bitstream
+        component_count = codec->color_sampled_component_count;
     }
 #endif
-    
-    // Compute the padding (in bytes) from the end of the component transform to the end of the chunk payload
-    padding = (int)((chunk_size * sizeof(SEGMENT)) - ((component_count + 2) * component_count) * sizeof(uint8_t));
-    
-    for (i = 0; i < component_count; i++)
+
+    return component_count;
+}
+
+/*!
+	@brief Translation unit local body of @ref ParseInverseComponentTransform
+
+	The component count is passed as an argument so callers inside this
+	translation unit that already know the count (the fused parser and a
+	future specialized caller) can inline the body with the count as a
+	constant, while the extern symbol keeps the published interface.
+*/
+static CODEC_ERROR ParseInverseComponentTransformImpl(DECODER *restrict decoder, BITSTREAM *restrict stream, uint32_t chunk_size, int component_count)
+{
+    CODEC_STATE *codec = &decoder->codec;
+    size_t payload_size = decoder->inverse_transform_payload;
+    size_t chunk_payload = chunk_size * sizeof(SEGMENT);
+    uint8_t payload[MAX_COMPONENT_COUNT * (MAX_COMPONENT_COUNT + 2)];
+    int row;
+
+    assert(component_count <= MAX_COMPONENT_COUNT && payload_size <= chunk_payload);
+    if (! (component_count <= MAX_COMPONENT_COUNT && payload_size <= chunk_payload)) {
+        return CODEC_ERROR_BITSTREAM_SYNTAX;
+    }
+
+    // Validate the chunk payload against the end of the stream once so the
+    // unchecked bulk reads below cannot run past the buffer
+    if (! (chunk_payload <= RemainingStreamBytes(stream->stream))) {
+        return CODEC_ERROR_BITSTREAM_SYNTAX;
+    }
+
+#if VC5_ENABLE_ICT_STORAGE
+#if defined(__GNUC__)
+    // Start fetching the payload, which may be cold right after input I/O,
+    // so the line arrives while the read below sets up (the payload can be
+    // up to 80 bytes so the tail may sit on a second cache line)
+    if (stream->stream->cur != NULL)
     {
-        int offset;
-        int scale;
-        int j;
-        
-        for (j = 0; j < component_count; j++)
-        {
-            int matrix_index = i * component_count + j;
-            int matrix_value = GetBits(stream, 8);
-            
-            //TODO: Need to save the value in the codec state
-            (void)matrix_index;
-            (void)matrix_value;
-        }
-        
-        offset = GetBits(stream, 8);
-        scale = GetBits(stream, 8);
-        
-        //TODO: Need to save the offset and scale in the codec state
-        (void)offset;
-        (void)scale;
+        __builtin_prefetch(stream->stream->cur, 0, 0);
+        __builtin_prefetch(stream->stream->cur + 64, 0, 0);
     }
+#endif
     
-    // Skip the padding at the end of the chunk payload
-    GetBits(stream, 8 * padding);
+    // The chunk payload is byte aligned, so the matrix together with the row
+    // offsets and scales is copied into a staging buffer in one bulk read
+    // instead of a shift and mask per byte
+    GetByteArray(stream, payload, payload_size);
+
+    // The bitstream appends the offset and scale to each matrix row, but the
+    // codec state stores the matrix as one contiguous block with the offsets
+    // and scales in their own arrays for the inverse transform apply kernel
+    // (the trip count is at most MAX_COMPONENT_COUNT, so ask the compiler
+    // to unroll the scatter into a straight-line sequence of copies)
+#if defined(__clang__)
+#pragma clang loop unroll(full)
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#pragma GCC unroll 8
+#endif
+    for (row = 0; row < component_count; row++)
+    {
+        const uint8_t *payload_row = payload + row * (component_count + 2);
+        memcpy(&codec->ict_matrix[row * component_count], payload_row, component_count);
+        codec->ict_offset[row] = payload_row[component_count];
+        codec->ict_scale[row] = payload_row[component_count + 1];
+    }
     
-    // Should be at the end of the last segment in the chunk
-    assert(IsAlignedSegment(stream));
+    // Skip the residual bytes up to the next segment boundary and then whole
+    // segments, so the stream is segment aligned by construction
+    SkipBits(stream, (uint32_t)(8 * ((chunk_payload - payload_size) % sizeof(SEGMENT))));
+    SkipSegments(stream, (chunk_payload - payload_size) / sizeof(SEGMENT));
+#else
+    // The stored transform is not used in this build, so skip the whole
+    // chunk payload without materializing any of the values
+    SkipSegments(stream, chunk_payload / sizeof(SEGMENT));
+#endif
     
     return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ParseInverseComponentPermutation(DECODER *decoder, BITSTREAM *stream, size_t chunk_size)
+CODEC_ERROR ParseInverseComponentTransform(DECODER *restrict decoder, BITSTREAM *restrict stream, uint32_t chunk_size)
+{
+    return ParseInverseComponentTransformImpl(decoder, stream, chunk_size, InverseComponentCount(decoder));
+}
+
+/*!
+	@brief Translation unit local body of @ref ParseInverseComponentPermutation
+
+	See the rationale for @ref ParseInverseComponentTransformImpl.
+*/
+static CODEC_ERROR ParseInverseComponentPermutationImpl(DECODER *restrict decoder, BITSTREAM *restrict stream, uint32_t chunk_size, int component_count)
 {
-    //CODEC_ERROR error = CODEC_ERROR_OKAY;
     CODEC_STATE *codec = &decoder->codec;
-    int component_count = codec->channel_count;
-    int padding;
+    size_t payload_size = decoder->inverse_permutation_payload;
+    size_t chunk_payload = chunk_size * sizeof(SEGMENT);
+    uint8_t payload[MAX_COMPONENT_COUNT];
+    uint64_t permutation = 0;
     int i;
     
-#if VC5_ENABLED_PART(VC5_PART_COLOR_SAMPLING)
-    if (IsPartEnabled(decoder->enabled_parts, VC5_PART_COLOR_SAMPLING))
+    assert(component_count <= MAX_COMPONENT_COUNT && payload_size <= chunk_payload);
+    if (! (component_count <= MAX_COMPONENT_COUNT && payload_size <= chunk_payload)) {
+        return CODEC_ERROR_BITSTREAM_SYNTAX;
+    }
+
+    // Validate the chunk payload against the end of the stream once so the
+    // unchecked bulk read below cannot run past the buffer
+    if (! (chunk_payload <= RemainingStreamBytes(stream->stream))) {
+        return CODEC_ERROR_BITSTREAM_SYNTAX;
+    }
+
+#if VC5_ENABLE_ICT_STORAGE
+#if defined(__GNUC__)
+    // The permutation payload fits in one cache line
+    if (stream->stream->cur != NULL)
     {
-        // Recompute the number of components to account for color difference component subsampling
-        component_count = codec->pattern_width * codec->pattern_height + 2;
+        __builtin_prefetch(stream->stream->cur, 0, 0);
     }
 #endif
     
-    // Compute the padding (in bytes) from the end of the component transform to the end of the chunk payload
-    padding = (int)((chunk_size * sizeof(SEGMENT)) - component_count * sizeof(uint8_t));
-    
+    // Read the permutation indices in one bulk read
+    GetByteArray(stream, payload, payload_size);
+
+    // Pack the indices into 8-bit lanes so the whole permutation lives in
+    // one register when it is applied to the decoded components (at most
+    // MAX_COMPONENT_COUNT lanes, so the pack unrolls to straight-line code)
+#if defined(__clang__)
+#pragma clang loop unroll(full)
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#pragma GCC unroll 8
+#endif
     for (i = 0; i < component_count; i++)
     {
-        int value;
-        
-        value = GetBits(stream, 8);
-        
-        //TODO: Need to save the permutation index in yhe codec state
-        (void)value;
+        permutation |= ((uint64_t)payload[i]) << (8 * i);
     }
+    codec->component_permutation = permutation;
     
-    // Skip the padding at the end of the chunk payload
-    GetBits(stream, 8 * padding);
-    
-    // Should be at the end of the last segment in the chunk
-    assert(IsAlignedSegment(stream));
+    // Skip the residual bytes up to the next segment boundary and then whole
+    // segments, so the stream is segment aligned by construction
+    SkipBits(stream, (uint32_t)(8 * ((chunk_payload - payload_size) % sizeof(SEGMENT))));
+    SkipSegments(stream, (chunk_payload - payload_size) / sizeof(SEGMENT));
+#else
+    // The stored permutation is not used in this build, so skip the whole
+    // chunk payload without materializing any of the values
+    SkipSegments(stream, chunk_payload / sizeof(SEGMENT));
+#endif
     
     return CODEC_ERROR_OKAY;
 }
+
+CODEC_ERROR ParseInverseComponentPermutation(DECODER *restrict decoder, BITSTREAM *restrict stream, uint32_t chunk_size)
+{
+    return ParseInverseComponentPermutationImpl(decoder, stream, chunk_size, InverseComponentCount(decoder));
+}
+
+/*!
+	@brief Parse consecutive inverse component transform and permutation chunks
+
+	Fused parser for the common layout where the inverse component
+	permutation chunk immediately follows the inverse component transform
+	chunk in the bitstream.  Both payloads are consumed with one pass over
+	the bitstream: the chunk header of the permutation chunk is read by
+	this routine and the padding between the two payloads reduces to a
+	single skip, avoiding the alignment bookkeeping that two separate
+	parser calls would repeat.
+
+	The VC-5 syntax does not require the two chunks to be adjacent, so the
+	tag dispatch in the decoder retains the individual parsers; this entry
+	point is for callers that know both chunks were written back-to-back.
+	The routine fails with a syntax error if the segment after the
+	transform chunk is not the permutation chunk header.
+*/
+CODEC_ERROR ParseInverseComponentTransformAndPermutation(DECODER *restrict decoder, BITSTREAM *restrict stream, uint32_t chunk_size)
+{
+    CODEC_ERROR error = CODEC_ERROR_OKAY;
+    TAGVALUE segment;
+    uint32_t permutation_chunk_size;
+
+    // Compute the component count once for both chunk payloads
+    int component_count = InverseComponentCount(decoder);
+
+    // Parse the inverse component transform chunk payload
+    error = ParseInverseComponentTransformImpl(decoder, stream, chunk_size, component_count);
+    if (error != CODEC_ERROR_OKAY) {
+        return error;
+    }
+
+    // The next segment must be the inverse component permutation chunk header
+    segment = GetSegment(stream);
+    if (segment.tuple.tag != CODEC_TAG_InversePermutation) {
+        return CODEC_ERROR_BITSTREAM_SYNTAX;
+    }
+
+    // The permutation is a small chunk so the size is the segment value
+    permutation_chunk_size = (uint32_t)(segment.tuple.value & 0xFFFF);
+
+    // Parse the inverse component permutation chunk payload
+    return ParseInverseComponentPermutationImpl(decoder, stream, permutation_chunk_size, component_count);
+}
@@ -25,9 +25,13 @@
 extern "C" {
 #endif
 
-    CODEC_ERROR ParseInverseComponentTransform(DECODER *decoder, BITSTREAM *stream, size_t chunk_size);
+    void UpdateInverseComponentPayloadSizes(DECODER *decoder);
 
-    CODEC_ERROR ParseInverseComponentPermutation(DECODER *decoder, BITSTREAM *stream, size_t chunk_size);
+    CODEC_ERROR ParseInverseComponentTransform(DECODER *restrict decoder, BITSTREAM *restrict stream, uint32_t chunk_size);
+
+    CODEC_ERROR ParseInverseComponentPermutation(DECODER *restrict decoder, BITSTREAM *restrict stream, uint32_t chunk_size);
+
+    CODEC_ERROR ParseInverseComponentTransformAndPermutation(DECODER *restrict decoder, BITSTREAM *restrict stream, uint32_t chunk_size);
 
 #ifdef __cplusplus
 }
@@ -20,20 +20,21 @@
 
 #include "headers.h"
 
-/*!
-	@brief Align the bitstream to a byte boundary
- 
-	Enough bits are removed from the bitstream buffer to
-	align the bitstream to the next byte.
- */
-static CODEC_ERROR AlignBitsByte(BITSTREAM *bitstream)
-{
-    // Compute the number of bits to skip
-    BITCOUNT count = bitstream->count % 8;
-    GetBits(bitstream, count);
-    assert((bitstream->count % 8) == 0);
-    return CODEC_ERROR_OKAY;
-}
+#if VC5_ENABLED_PART(VC5_PART_SECTIONS)
+// Forward reference
+CODEC_ERROR FlushSectionInformation(DECODER *decoder);
+#endif
+
+// The inverse wavelet transforms that run while the bitstream is being
+// parsed are handed to worker threads as OpenMP tasks so that the memory
+// bound transform overlaps the entropy decoding of the next bands.  Task
+// dependences require OpenMP 3.0, so older runtimes fall back to running
+// the transforms inline.
+#if defined(GPR_USE_OPENMP) && defined(_OPENMP) && _OPENMP >= 200805
+#define VC5_DECODER_TASKS 1
+#else
+#define VC5_DECODER_TASKS 0
+#endif
 
 /*!
 	@brief Align the bitstream to the next word boundary
@@ -41,7 +42,7 @@ static CODEC_ERROR AlignBitsByte(BITSTREAM *bitstream)
 	All of the bits in the bitstream buffer are flushed unless
 	the bitstream buffer is completely empty or completely full.
  */
-static CODEC_ERROR AlignBitsWord(BITSTREAM *bitstream)
+STATIC_INLINE CODEC_ERROR AlignBitsWord(BITSTREAM *bitstream)
 {
     BITCOUNT count = bitstream->count;
     
@@ -55,26 +56,28 @@ static CODEC_ERROR AlignBitsWord(BITSTREAM *bitstream)
 /*!
 	@brief Align the bitstream to the next tag value pair
  */
-static CODEC_ERROR AlignBitsSegment(BITSTREAM *bitstream)
+STATIC_INLINE CODEC_ERROR AlignBitsSegment(BITSTREAM *bitstream)
 {
     STREAM *stream = bitstream->stream;
     size_t byte_count;
+    size_t pad;
     
-    // Byte align the bitstream
-    AlignBitsByte(bitstream);
-    assert((bitstream->count % 8) == 0);
+    // Compute the number of residual bits past the last byte boundary
+    uint32_t residual_bits = (uint32_t)(bitstream->count % 8);
     
-    // Compute the number of bytes in the bit buffer
+    // Compute the number of whole bytes in the bit buffer
     byte_count = bitstream->count / 8;
     
     // Add the number of bytes read from the stream
     byte_count += stream->byte_count;
     
-    while ((byte_count % sizeof(TAGVALUE)) != 0)
-    {
-        GetBits(bitstream, 8);
-        byte_count++;
-    }
+    // Compute the number of padding bytes before the next segment boundary
+    // (branchless since the segment size is a power of two), then drop the
+    // residual bits and the padding with one skip instead of a separate
+    // byte alignment pass and a byte at a time loop
+    pad = (0 - byte_count) & (sizeof(TAGVALUE) - 1);
+    SkipBits(bitstream, residual_bits + (uint32_t)(8 * pad));
+    byte_count += pad;
     
     // The bitstream should be aligned to the next segment
     assert((bitstream->count == 0) || (bitstream->count == bit_word_count));
@@ -112,9 +115,20 @@ CODEC_ERROR InitDecoder(DECODER *decoder, const gpr_allocator *allocator)
  */
 CODEC_ERROR ReleaseDecoder(DECODER *decoder)
 {
+#if VC5_ENABLED_PART(VC5_PART_SECTIONS)
+    // Write out any section records buffered for the log file
+    if (decoder->section_logfile != NULL && decoder->section_record_count > 0)
+    {
+        FlushSectionInformation(decoder);
+    }
+#endif
+    
     // Free the wavelet transforms and decoding buffers
     ReleaseDecoderTransforms(decoder);
     ReleaseDecoderBuffers(decoder);
+
+    // Free the band data allocations parked for reuse
+    FlushWaveletPool();
     
     return CODEC_ERROR_OKAY;
 }
@@ -164,6 +178,56 @@ CODEC_ERROR DecodeStream(STREAM *stream, UNPACKED_IMAGE *unpacked_image, const D
 	may be available to the decoder from the media container or an external
 	application.
  */
+/*!
+	@brief Convert decoded wavelet bands to RGB at the requested resolution
+
+	All of the reduced resolution outputs funnel through this one dispatch
+	point: the half resolution output reads the unpacked component arrays
+	and the lower resolutions read the lowpass bands of the corresponding
+	wavelet level directly.  Keeping the band selection separate from the
+	conversion leaves a single seam where an accelerator backend could
+	substitute its own conversion without duplicating the per resolution
+	logic.
+*/
+static CODEC_ERROR WaveletBandsToRGB(DECODER *decoder, const UNPACKED_IMAGE *unpacked_image,
+                                     RGB_IMAGE *rgb_image, DECODER_PARAMETERS *parameters)
+{
+    int wavelet_index;
+    WAVELET *wavelet;
+
+    switch (parameters->rgb_resolution) {
+
+        case GPR_RGB_RESOLUTION_HALF:
+            WaveletToRGB(parameters->allocator, (PIXEL*)unpacked_image->component_array_list[0].data, (PIXEL*)unpacked_image->component_array_list[1].data, (PIXEL*)unpacked_image->component_array_list[2].data,
+                         unpacked_image->component_array_list[2].width, unpacked_image->component_array_list[2].height, unpacked_image->component_array_list[2].pitch / 2,
+                         rgb_image, 12, parameters->rgb_bits, &parameters->rgb_gain );
+            return CODEC_ERROR_OKAY;
+
+        case GPR_RGB_RESOLUTION_QUARTER:
+            wavelet_index = 0;
+            break;
+
+        case GPR_RGB_RESOLUTION_EIGHTH:
+            wavelet_index = 1;
+            break;
+
+        case GPR_RGB_RESOLUTION_SIXTEENTH:
+            wavelet_index = 2;
+            break;
+
+        default:
+            return CODEC_ERROR_UNSUPPORTED_FORMAT;
+    }
+
+    wavelet = decoder->transform[2].wavelet[wavelet_index];
+
+    WaveletToRGB(parameters->allocator, decoder->transform[0].wavelet[wavelet_index]->data[0], decoder->transform[1].wavelet[wavelet_index]->data[0], wavelet->data[0],
+                 wavelet->width, wavelet->height, (DIMENSION)(wavelet->pitch / sizeof(PIXEL)),
+                 rgb_image, 14, parameters->rgb_bits, &parameters->rgb_gain );
+
+    return CODEC_ERROR_OKAY;
+}
+
 CODEC_ERROR DecodeImage(STREAM *stream, IMAGE *packed_image, RGB_IMAGE *rgb_image, DECODER_PARAMETERS *parameters)
 {
     CODEC_ERROR error = CODEC_ERROR_OKAY;
@@ -198,50 +262,24 @@ CODEC_ERROR DecodeImage(STREAM *stream, IMAGE *packed_image, RGB_IMAGE *rgb_imag
         return error;
     }
 
-    switch (parameters->rgb_resolution) {
-
-        case GPR_RGB_RESOLUTION_NONE:
-            // The dimensions and format for the output of the image packing process
-            SetOutputImageFormat(&decoder, parameters, &packed_width, &packed_height, &packed_format);
-
-            // Allocate the image buffer for output of the image packing process
-            AllocImage(decoder.allocator, packed_image, packed_width, packed_height, packed_format);
-            
-            // Pack the component arrays into the output image
-            ImageRepackingProcess(&unpacked_image, packed_image, parameters);
-            break;
-
-        case GPR_RGB_RESOLUTION_HALF:
-            WaveletToRGB(parameters->allocator, (PIXEL*)unpacked_image.component_array_list[0].data, (PIXEL*)unpacked_image.component_array_list[1].data, (PIXEL*)unpacked_image.component_array_list[2].data,
-                         unpacked_image.component_array_list[2].width, unpacked_image.component_array_list[2].height, unpacked_image.component_array_list[2].pitch / 2,
-                         rgb_image, 12, parameters->rgb_bits, &parameters->rgb_gain );
-            break;
-            
-        case GPR_RGB_RESOLUTION_QUARTER:
-            
-            WaveletToRGB(parameters->allocator, decoder.transform[0].wavelet[0]->data[0], decoder.transform[1].wavelet[0]->data[0], decoder.transform[2].wavelet[0]->data[0],
-                         decoder.transform[2].wavelet[0]->width, decoder.transform[2].wavelet[0]->height, decoder.transform[2].wavelet[0]->width,
-                         rgb_image, 14, parameters->rgb_bits, &parameters->rgb_gain );
-            break;
-            
-        case GPR_RGB_RESOLUTION_EIGHTH:
-            
-            WaveletToRGB(parameters->allocator, decoder.transform[0].wavelet[1]->data[0], decoder.transform[1].wavelet[1]->data[0], decoder.transform[2].wavelet[1]->data[0],
-                         decoder.transform[2].wavelet[1]->width, decoder.transform[2].wavelet[1]->height, decoder.transform[2].wavelet[1]->width,
-                         rgb_image, 14, parameters->rgb_bits, &parameters->rgb_gain );
-            
-            break;
-            
-        case GPR_RGB_RESOLUTION_SIXTEENTH:
+    if (parameters->rgb_resolution == GPR_RGB_RESOLUTION_NONE)
+    {
+        // The dimensions and format for the output of the image packing process
+        SetOutputImageFormat(&decoder, parameters, &packed_width, &packed_height, &packed_format);
 
-            WaveletToRGB(parameters->allocator, decoder.transform[0].wavelet[2]->data[0], decoder.transform[1].wavelet[2]->data[0], decoder.transform[2].wavelet[2]->data[0],
-                         decoder.transform[2].wavelet[2]->width, decoder.transform[2].wavelet[2]->height, decoder.transform[2].wavelet[2]->width,
-                         rgb_image, 14, parameters->rgb_bits, &parameters->rgb_gain );
-            break;
-            
-        default:
-            return CODEC_ERROR_UNSUPPORTED_FORMAT;
-            break;
+        // Allocate the image buffer for output of the image packing process
+        AllocImage(decoder.allocator, packed_image, packed_width, packed_height, packed_format);
+        
+        // Pack the component arrays into the output image
+        ImageRepackingProcess(&unpacked_image, packed_image, parameters);
+    }
+    else
+    {
+        // Convert the wavelet bands to RGB at the requested resolution
+        error = WaveletBandsToRGB(&decoder, &unpacked_image, rgb_image, parameters);
+        if (error != CODEC_ERROR_OKAY) {
+            return error;
+        }
     }
     
     ReleaseComponentArrays( &parameters->allocator, &unpacked_image, unpacked_image.component_count );
@@ -301,7 +339,42 @@ CODEC_ERROR PrepareDecoder(DECODER *decoder, const DECODER_PARAMETERS *parameter
     }
 #endif
     
-    decoder->subbands_to_decode = MAX_SUBBAND_COUNT;
+    // Set the number of subbands to decode and whether the component arrays
+    // must be reconstructed from the requested output resolution (indexed by
+    // the resolution, so the decision is two table loads instead of a chain
+    // of comparisons)
+    {
+        //! Number of subbands to decode for each output resolution
+        static const uint8_t subband_count_table[] = {
+            MAX_SUBBAND_COUNT,	// (unused)
+            1,					// GPR_RGB_RESOLUTION_SIXTEENTH
+            4,					// GPR_RGB_RESOLUTION_EIGHTH
+            7,					// GPR_RGB_RESOLUTION_QUARTER
+            MAX_SUBBAND_COUNT,	// GPR_RGB_RESOLUTION_HALF
+            MAX_SUBBAND_COUNT,	// GPR_RGB_RESOLUTION_FULL
+            MAX_SUBBAND_COUNT,	// GPR_RGB_RESOLUTION_NONE
+        };
+        
+        //! True for the resolutions that reconstruct the component arrays
+        //! from the last decoded wavelet instead of reading bands directly
+        static const bool reconstruct_table[] = {
+            false,				// (unused)
+            false,				// GPR_RGB_RESOLUTION_SIXTEENTH
+            false,				// GPR_RGB_RESOLUTION_EIGHTH
+            false,				// GPR_RGB_RESOLUTION_QUARTER
+            true,				// GPR_RGB_RESOLUTION_HALF
+            true,				// GPR_RGB_RESOLUTION_FULL
+            true,				// GPR_RGB_RESOLUTION_NONE
+        };
+        
+        unsigned int resolution = (unsigned int)parameters->rgb_resolution;
+        if (resolution > GPR_RGB_RESOLUTION_NONE) {
+            resolution = GPR_RGB_RESOLUTION_NONE;
+        }
+        
+        decoder->subbands_to_decode = subband_count_table[resolution];
+        decoder->reconstruct_unpacked = reconstruct_table[resolution];
+    }
     
     return error;
 }
@@ -331,20 +404,6 @@ CODEC_ERROR DecodingProcess(DECODER *decoder, BITSTREAM *stream, UNPACKED_IMAGE
         return CODEC_ERROR_MISSING_START_MARKER;
     }
 
-    // Set up number of subbands to decode
-    if( parameters->rgb_resolution == GPR_RGB_RESOLUTION_SIXTEENTH )
-    {
-        decoder->subbands_to_decode = 1;
-    }
-    else if( parameters->rgb_resolution == GPR_RGB_RESOLUTION_EIGHTH )
-    {
-        decoder->subbands_to_decode = 4;
-    }
-    else if( parameters->rgb_resolution == GPR_RGB_RESOLUTION_QUARTER )
-    {
-        decoder->subbands_to_decode = 7;
-    }
-    
 #if VC5_ENABLED_PART(VC5_PART_LAYERS)
     // Decode each layer in the sample
     if (decoder->layer_count > 1)
@@ -429,6 +488,16 @@ CODEC_ERROR DecodeSampleLayer(DECODER *decoder, BITSTREAM *input, UNPACKED_IMAGE
             break;
         }
         
+#if defined(__GNUC__)
+        // Start fetching the line after the current read position so the
+        // next tag value pair is in cache by the time the codec state
+        // update for this one has been processed
+        if (input->stream->cur != NULL)
+        {
+            __builtin_prefetch(input->stream->cur + 64, 0, 0);
+        }
+#endif
+        
         error = UpdateCodecState(decoder, input, segment);
         if (error != CODEC_ERROR_OKAY) {
             return error;
@@ -460,6 +529,15 @@ CODEC_ERROR DecodeSingleImage(DECODER *decoder, BITSTREAM *input, UNPACKED_IMAGE
     
     CODEC_STATE *codec = &decoder->codec;
     
+    // The bitstream is parsed by one thread; the inverse wavelet
+    // transforms spawned by @ref ReconstructWaveletBand run as tasks on
+    // the other threads in the team and are all complete when the
+    // parallel region ends
+#if VC5_DECODER_TASKS
+    #pragma omp parallel
+    #pragma omp single
+#endif
+    {
     // Process tag value pairs until the layer has been decoded
     for (;;)
     {
@@ -470,13 +548,23 @@ CODEC_ERROR DecodeSingleImage(DECODER *decoder, BITSTREAM *input, UNPACKED_IMAGE
         assert(input->error == BITSTREAM_ERROR_OKAY);
         if (input->error != BITSTREAM_ERROR_OKAY) {
             decoder->error = CodecErrorBitstream(input->error);
-            return decoder->error;
+            error = decoder->error;
             break;
         }
         
+#if defined(__GNUC__)
+        // Start fetching the line after the current read position so the
+        // next tag value pair is in cache by the time the codec state
+        // update for this one has been processed
+        if (input->stream->cur != NULL)
+        {
+            __builtin_prefetch(input->stream->cur + 64, 0, 0);
+        }
+#endif
+        
         error = UpdateCodecState(decoder, input, segment);
         if (error != CODEC_ERROR_OKAY) {
-            return error;
+            break;
         }
         
         // Processed all wavelet bands in all channels?
@@ -484,6 +572,7 @@ CODEC_ERROR DecodeSingleImage(DECODER *decoder, BITSTREAM *input, UNPACKED_IMAGE
             break;
         }
     }
+    }
     
     // Parsed the bitstream without errors?
     if (error != CODEC_ERROR_OKAY) {
@@ -492,9 +581,7 @@ CODEC_ERROR DecodeSingleImage(DECODER *decoder, BITSTREAM *input, UNPACKED_IMAGE
     
     TIMESTAMP("[END]", 2)
     
-    if( parameters->rgb_resolution == GPR_RGB_RESOLUTION_NONE ||
-        parameters->rgb_resolution == GPR_RGB_RESOLUTION_HALF ||
-        parameters->rgb_resolution == GPR_RGB_RESOLUTION_FULL )
+    if (decoder->reconstruct_unpacked)
     {
         // Reconstruct the output image using the last decoded wavelet in each channel
         error = ReconstructUnpackedImage(decoder, image);
@@ -561,6 +648,54 @@ CODEC_ERROR SetImageChannelParameters(DECODER *decoder, int channel_number)
 }
 #endif
 
+/*!
+	@brief Zero the band memory of a newly allocated decoder wavelet
+
+	The run length decoder relies on the band memory starting out zero so
+	that runs of zeros only advance the position in the band instead of
+	storing every coefficient.  The wavelet allocations can be recycled
+	from the pool, so the bands are cleared explicitly; the four bands are
+	carved consecutively from one block (see @ref AllocWavelet).
+ */
+STATIC_INLINE void ZeroWaveletBands(WAVELET *wavelet)
+{
+    if (wavelet != NULL && wavelet->data[0] != NULL)
+    {
+        memset(wavelet->data[0], 0, (size_t)wavelet->pitch * wavelet->height * MAX_BAND_COUNT);
+    }
+}
+
+/*!
+	@brief Allocate the vector of wavelet trees for the actual channel count
+
+	The transform array was a fixed vector of MAX_CHANNEL_COUNT wavelet
+	trees embedded in the decoder; it is now allocated on first use and
+	sized to the channel count parsed from the bitstream.  The array is
+	zeroed so that the wavelet pointers start out null and the wavelets
+	are created on demand.
+ */
+STATIC_INLINE CODEC_ERROR AllocateTransformArray(DECODER *decoder)
+{
+    if (decoder->transform == NULL)
+    {
+        int channel_count = decoder->codec.channel_count;
+        size_t transform_size = channel_count * sizeof(TRANSFORM);
+        
+        assert(0 < channel_count && channel_count <= MAX_CHANNEL_COUNT);
+        
+        decoder->transform = (TRANSFORM *)decoder->allocator->Alloc(transform_size);
+        assert(decoder->transform != NULL);
+        if (! (decoder->transform != NULL)) {
+            return CODEC_ERROR_OUTOFMEMORY;
+        }
+        
+        memset(decoder->transform, 0, transform_size);
+        decoder->transform_count = channel_count;
+    }
+    
+    return CODEC_ERROR_OKAY;
+}
+
 #if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
 /*!
 	@brief Allocate all of the wavelets used during decoding
@@ -589,14 +724,22 @@ CODEC_ERROR AllocDecoderTransforms(DECODER *decoder)
         return CODEC_ERROR_NULLPTR;
     }
     
+    DIMENSION wavelet_width[MAX_CHANNEL_COUNT];
+    DIMENSION wavelet_height[MAX_CHANNEL_COUNT];
+    
     channel_count = decoder->codec.channel_count;
     wavelet_count = decoder->wavelet_count;
     
+    assert(channel_count <= MAX_CHANNEL_COUNT);
+    
+    // Allocate the vector of wavelet trees on first use
+    result = AllocateTransformArray(decoder);
+    if (result != CODEC_ERROR_OKAY) {
+        return result;
+    }
+    
     for (channel_number = 0; channel_number < channel_count; channel_number++)
     {
-        DIMENSION wavelet_width;
-        DIMENSION wavelet_height;
-        
         // Set the channel dimensions using the information obtained from the bitstream header
         result = SetImageChannelParameters(decoder, channel_number);
         if( result != CODEC_ERROR_OKAY )
@@ -609,31 +752,29 @@ CODEC_ERROR AllocDecoderTransforms(DECODER *decoder)
         assert(decoder->channel[channel_number].initialized);
         
         // The dimensions of the wavelet at level zero are equal to the channel dimensions
-        wavelet_width = decoder->channel[channel_number].width;
-        wavelet_height = decoder->channel[channel_number].height;
-        
-        for (wavelet_index = 0; wavelet_index < wavelet_count; wavelet_index++)
+        wavelet_width[channel_number] = decoder->channel[channel_number].width;
+        wavelet_height[channel_number] = decoder->channel[channel_number].height;
+    }
+    
+    // Allocate the wavelets in level major order so the bands at the same
+    // level of every channel are adjacent in memory: the reconstruction and
+    // color transform passes walk the same level across all of the channels,
+    // so adjacent allocations keep those accesses within a smaller working
+    // set than per channel allocation order
+    for (wavelet_index = 0; wavelet_index < wavelet_count; wavelet_index++)
+    {
+        for (channel_number = 0; channel_number < channel_count; channel_number++)
         {
             WAVELET *wavelet;
             
-            // Pad the wavelet width if necessary
-            if ((wavelet_width % 2) != 0) {
-                wavelet_width++;
-            }
-            
-            // Pad the wavelet height if necessary
-            if ((wavelet_height % 2) != 0) {
-                wavelet_height++;
-            }
-            
-            // Dimensions of the current wavelet must be divisible by two
-            assert((wavelet_width % 2) == 0 && (wavelet_height % 2) == 0);
-            
-            // Reduce the dimensions of the next wavelet by half
-            wavelet_width /= 2;
-            wavelet_height /= 2;
+            // Pad the wavelet dimensions to even values and reduce the
+            // dimensions of the next wavelet by half (branchless, so the
+            // dimensions are a pure data dependency on the channel size)
+            wavelet_width[channel_number] = (DIMENSION)(((wavelet_width[channel_number] + 1) & ~1u) / 2);
+            wavelet_height[channel_number] = (DIMENSION)(((wavelet_height[channel_number] + 1) & ~1u) / 2);
             
-            wavelet = CreateWavelet(allocator, wavelet_width, wavelet_height);
+            wavelet = CreateWavelet(allocator, wavelet_width[channel_number], wavelet_height[channel_number]);
+            ZeroWaveletBands(wavelet);
             decoder->transform[channel_number].wavelet[wavelet_index] = wavelet;
         }
     }
@@ -647,9 +788,13 @@ CODEC_ERROR AllocDecoderTransforms(DECODER *decoder)
  */
 CODEC_ERROR ReleaseDecoderTransforms(DECODER *decoder)
 {
-    int channel_count = decoder->codec.channel_count;
+    int channel_count = decoder->transform_count;
     int channel_index;
     
+    if (decoder->transform == NULL) {
+        return CODEC_ERROR_OKAY;
+    }
+    
     for (channel_index = 0; channel_index < channel_count; channel_index++)
     {
         int wavelet_index;
@@ -661,6 +806,10 @@ CODEC_ERROR ReleaseDecoderTransforms(DECODER *decoder)
         }
     }
     
+    decoder->allocator->Free(decoder->transform);
+    decoder->transform = NULL;
+    decoder->transform_count = 0;
+    
     return CODEC_ERROR_OKAY;
 }
 
@@ -713,8 +862,8 @@ CODEC_ERROR AllocateChannelWavelets(DECODER *decoder, int channel_number)
 #endif
     
     // Round up the wavelet dimensions to an even number
-    DIMENSION wavelet_width = ((channel_width % 2) == 0) ? channel_width / 2 : (channel_width + 1) / 2;
-    DIMENSION wavelet_height = ((channel_height % 2) == 0) ? channel_height / 2 : (channel_height + 1) / 2;
+    DIMENSION wavelet_width = (DIMENSION)(((channel_width + 1) & ~1u) / 2);
+    DIMENSION wavelet_height = (DIMENSION)(((channel_height + 1) & ~1u) / 2);
     
     //TODO: Check for errors before the code that initializes the local variables
     assert(decoder != NULL);
@@ -722,6 +871,14 @@ CODEC_ERROR AllocateChannelWavelets(DECODER *decoder, int channel_number)
         return CODEC_ERROR_NULLPTR;
     }
     
+    // Allocate the vector of wavelet trees on first use
+    {
+        CODEC_ERROR error = AllocateTransformArray(decoder);
+        if (error != CODEC_ERROR_OKAY) {
+            return error;
+        }
+    }
+    
     for (wavelet_index = 0; wavelet_index < decoder->wavelet_count; wavelet_index++)
     {
         WAVELET *wavelet = decoder->transform[channel_number].wavelet[wavelet_index];
@@ -745,25 +902,15 @@ CODEC_ERROR AllocateChannelWavelets(DECODER *decoder, int channel_number)
             wavelet = CreateWavelet(allocator, wavelet_width, wavelet_height);
             assert(wavelet != NULL);
             
+            ZeroWaveletBands(wavelet);
+            
             decoder->transform[channel_number].wavelet[wavelet_index] = wavelet;
         }
         
-        // Pad the wavelet width if necessary
-        if ((wavelet_width % 2) != 0) {
-            wavelet_width++;
-        }
-        
-        // Pad the wavelet height if necessary
-        if ((wavelet_height % 2) != 0) {
-            wavelet_height++;
-        }
-        
-        // Dimensions of the current wavelet must be divisible by two
-        assert((wavelet_width % 2) == 0 && (wavelet_height % 2) == 0);
-        
-        // Reduce the dimensions of the next wavelet by half
-        wavelet_width /= 2;
-        wavelet_height /= 2;
+        // Pad the wavelet dimensions to even values and reduce the
+        // dimensions of the next wavelet by half (branchless)
+        wavelet_width = (DIMENSION)(((wavelet_width + 1) & ~1u) / 2);
+        wavelet_height = (DIMENSION)(((wavelet_height + 1) & ~1u) / 2);
     }
     
     return CODEC_ERROR_OKAY;
@@ -780,12 +927,19 @@ CODEC_ERROR PrepareDecoderState(DECODER *decoder, const DECODER_PARAMETERS *para
     // Set the parameters that control the decoding process
     decoder->wavelet_count = 3;
     
+    // Clear the table of information about each decoded channel, but only
+    // when the decoder is being prepared again for another sample: on the
+    // first call the entire decoder was just zeroed by @ref InitDecoder and
+    // clearing the channel table again would rewrite several hundred bytes
+    // that are already zero
+    if (decoder->memory_allocated)
+    {
+        memset(decoder->channel, 0, sizeof(decoder->channel));
+    }
+    
     // The wavelets and decoding buffers have not been allocated
     decoder->memory_allocated = false;
     
-    // Clear the table of information about each decoded channel
-    memset(decoder->channel, 0, sizeof(decoder->channel));
-    
     // Set the codebook
     decoder->codebook = (CODEBOOK *)decoder_codeset_17.codebook;
     
@@ -805,6 +959,9 @@ CODEC_ERROR PrepareDecoderState(DECODER *decoder, const DECODER_PARAMETERS *para
     codec->channel_width = codec->image_width;
     codec->channel_height = codec->image_height;
     
+    // Cache the payload sizes for the default component count
+    UpdateInverseComponentPayloadSizes(decoder);
+    
     return error;
 }
 
@@ -846,37 +1003,33 @@ CODEC_ERROR ImageRepackingProcess(const UNPACKED_IMAGE *unpacked_image,
                                   PACKED_IMAGE *packed_image,
                                   const DECODER_PARAMETERS *parameters)
 {
-    DIMENSION output_width = packed_image->width;
-    DIMENSION output_height = packed_image->height;
-    size_t output_pitch = packed_image->pitch;
+    // The dimensions must be in units of Bayer pattern elements (the locals
+    // are initialized once and never modified, so the compiler can propagate
+    // them into the packing calls without assuming they alias the image)
+    const DIMENSION output_width = (DIMENSION)(packed_image->width >> 1);
+    const DIMENSION output_height = (DIMENSION)(packed_image->height >> 1);
+    const size_t output_pitch = (size_t)packed_image->pitch << 1;
     PIXEL_FORMAT output_format = packed_image->format;
     PIXEL *output_buffer = packed_image->buffer;
     ENABLED_PARTS enabled_parts = parameters->enabled_parts;
     
     (void)parameters;
 
-    // The dimensions must be in units of Bayer pattern elements
-    output_width /= 2;
-    output_height /= 2;
-    output_pitch *= 2;
-
     switch (output_format)
     {
         case PIXEL_FORMAT_RAW_RGGB_12:
         case PIXEL_FORMAT_RAW_GBRG_12:
-            return PackComponentsToRAW(unpacked_image, output_buffer, output_pitch,
-                                        output_width, output_height, enabled_parts, 12, output_format );
+            return PackComponentsToRAW_12(unpacked_image, output_buffer, output_pitch,
+                                          output_width, output_height, enabled_parts, output_format );
             
         case PIXEL_FORMAT_RAW_RGGB_14:
         case PIXEL_FORMAT_RAW_GBRG_14:
-            return PackComponentsToRAW(unpacked_image, output_buffer, output_pitch,
-                                        output_width, output_height, enabled_parts, 14, output_format );
-            break;
+            return PackComponentsToRAW_14(unpacked_image, output_buffer, output_pitch,
+                                          output_width, output_height, enabled_parts, output_format );
             
         case PIXEL_FORMAT_RAW_RGGB_16:
-            return PackComponentsToRAW(unpacked_image, output_buffer, output_pitch,
-                                        output_width, output_height, enabled_parts, 16, output_format );
-            break;
+            return PackComponentsToRAW_16(unpacked_image, output_buffer, output_pitch,
+                                          output_width, output_height, enabled_parts, output_format );
             
         default:
             assert(0);
@@ -944,65 +1097,52 @@ bool ChannelLowpassBandsAllValid(const DECODER *decoder, int index)
 
 #if VC5_ENABLED_PART(VC5_PART_SECTIONS)
 
+//! Section number for each section header tag, indexed by the high byte
+//! of the tag relative to the smallest section tag (zero marks the gaps
+//! in the tag range that are not section headers)
+static const int8_t section_number_table[] = {
+    6,	// CODEC_TAG_SubbandSectionTag (0x2000)
+    5,	// CODEC_TAG_WaveletSectionTag (0x2100)
+    0,	// (0x2200 is not a section header)
+    0,	// (0x2300 is not a section header)
+    4,	// CODEC_TAG_ChannelSectionTag (0x2400)
+    2,	// CODEC_TAG_HeaderSectionTag (0x2500)
+    3,	// CODEC_TAG_LayerSectionTag (0x2600)
+    1,	// CODEC_TAG_ImageSectionTag (0x2700)
+};
+
 /*
- @brief Return true if the tag identifies a section header
+ @brief Map a section header tag to its section number (zero if the tag
+ is not a section header)
  */
-bool IsSectionHeader(TAGWORD tag)
+static int SectionNumber(TAGWORD tag)
 {
-    switch (tag)
-    {
-        case CODEC_TAG_ImageSectionTag:
-        case CODEC_TAG_HeaderSectionTag:
-        case CODEC_TAG_LayerSectionTag:
-        case CODEC_TAG_ChannelSectionTag:
-        case CODEC_TAG_WaveletSectionTag:
-        case CODEC_TAG_SubbandSectionTag:
-            return true;
-            
-        default:
-            return false;
+    unsigned int index = ((unsigned int)tag >> 8) - 0x20;
+    
+    // The low byte of every section header tag is zero
+    if ((tag & 0xFF) != 0 || index >= sizeof(section_number_table)) {
+        return 0;
     }
     
-    return false;
+    return section_number_table[index];
+}
+
+/*
+ @brief Return true if the tag identifies a section header
+ */
+STATIC_INLINE bool IsSectionHeader(TAGWORD tag)
+{
+    return SectionNumber(tag) != 0;
 }
 
 /*
  @brief Map the tag for a section header to the section number
  */
-CODEC_ERROR GetSectionNumber(TAGWORD tag, int *section_number_out)
+static CODEC_ERROR GetSectionNumber(TAGWORD tag, int *section_number_out)
 {
-    int section_number = 0;
+    int section_number = SectionNumber(tag);
     
-    switch (tag)
-    {
-        case CODEC_TAG_ImageSectionTag:
-            section_number = 1;
-            break;
-            
-        case CODEC_TAG_HeaderSectionTag:
-            section_number = 2;
-            break;
-            
-        case CODEC_TAG_LayerSectionTag:
-            section_number = 3;
-            break;
-            
-        case CODEC_TAG_ChannelSectionTag:
-            section_number = 4;
-            break;
-            
-        case CODEC_TAG_WaveletSectionTag:
-            section_number = 5;
-            break;
-            
-        case CODEC_TAG_SubbandSectionTag:
-            section_number = 6;
-            break;
-            
-        default:
-            assert(0);
-            break;
-    }
+    assert(section_number > 0);
     
     if (section_number_out != NULL) {
         *section_number_out = section_number;
@@ -1016,11 +1156,44 @@ CODEC_ERROR GetSectionNumber(TAGWORD tag, int *section_number_out)
 }
 
 /*!
- @brief Write section information to the section log file
+ @brief Flush the buffered section records to the section log file
+ 
+ The formatting and the stdio locking run once per flush instead of
+ once per section encountered on the parsing path.
+ */
+CODEC_ERROR FlushSectionInformation(DECODER *decoder)
+{
+    int i;
+    
+    for (i = 0; i < decoder->section_record_count; i++)
+    {
+        fprintf(decoder->section_logfile, "Section: %d, length: %d\n",
+                decoder->section_record[i].number, (int)decoder->section_record[i].length);
+    }
+    decoder->section_record_count = 0;
+    
+    return CODEC_ERROR_OKAY;
+}
+
+/*!
+ @brief Record section information for the section log file
+ 
+ The record is appended to a buffer on the decoder and written out by
+ @ref FlushSectionInformation, so the parsing path does not format or
+ lock the log stream per section.
  */
-CODEC_ERROR WriteSectionInformation(FILE *logfile, int section_number, int section_length)
+CODEC_ERROR WriteSectionInformation(DECODER *decoder, int section_number, int section_length)
 {
-    fprintf(logfile, "Section: %d, length: %d\n", section_number, section_length);
+    if (decoder->section_record_count == (int)(sizeof(decoder->section_record) / sizeof(decoder->section_record[0])))
+    {
+        // The buffer is full, so write out the buffered records
+        FlushSectionInformation(decoder);
+    }
+    
+    decoder->section_record[decoder->section_record_count].number = (uint16_t)section_number;
+    decoder->section_record[decoder->section_record_count].length = (uint32_t)section_length;
+    decoder->section_record_count++;
+    
     return CODEC_ERROR_OKAY;
 }
 
@@ -1041,6 +1214,11 @@ static CODEC_ERROR SkipPayload(BITSTREAM *bitstream, int chunk_size)
     // This routine assumes that the bit buffer is empty
     assert(bitstream->count == 0);
     
+    // Nothing to skip for an empty payload
+    if (size == 0) {
+        return CODEC_ERROR_OKAY;
+    }
+    
     // Skip the specified number of bytes in the stream
     return SkipBytes(bitstream->stream, size);
 }
@@ -1059,29 +1237,38 @@ static CODEC_ERROR ParseUniqueImageIdentifier(DECODER *decoder, BITSTREAM *strea
     const int identifier_chunk_payload_length = UMID_length + sequence_number_length;
     
     uint8_t byte_array[12];
-    BITWORD length_byte;
-    BITWORD instance_number;
+    BITWORD header_word;
     
     // Check that the chunk payload has the correct length (in segments)
     if (identifier_length != identifier_chunk_payload_length) {
         return CODEC_ERROR_SYNTAX_ERROR;
     }
     
-    // The unique image identifier chunk should begin with a UMID label
+    // The unique image identifier chunk should begin with a UMID label.
+    // Compare the twelve bytes as three words folded into one difference,
+    // so the check is a handful of loads and a single branch regardless
+    // of how the compiler expands a library compare
     GetByteArray(stream, byte_array, sizeof(byte_array));
-    if (memcmp(byte_array, UMID_label, sizeof(UMID_label)) != 0) {
-        return CODEC_ERROR_UMID_LABEL;
-    }
-    
-    // Check the UMID length byte
-    length_byte = GetBits(stream, 8);
-    if (length_byte != UMID_length_byte) {
-        return CODEC_ERROR_SYNTAX_ERROR;
+    {
+        uint32_t stream_words[3];
+        uint32_t label_words[3];
+        
+        memcpy(stream_words, byte_array, sizeof(stream_words));
+        memcpy(label_words, UMID_label, sizeof(label_words));
+        
+        if (((stream_words[0] ^ label_words[0]) |
+             (stream_words[1] ^ label_words[1]) |
+             (stream_words[2] ^ label_words[2])) != 0) {
+            return CODEC_ERROR_UMID_LABEL;
+        }
     }
     
-    // Check the UMID instance number
-    instance_number = GetBits(stream, 24);
-    if (instance_number != UMID_instance_number) {
+    // Check the UMID length byte and instance number with one 32-bit
+    // read instead of separate 8-bit and 24-bit reads, so the bit buffer
+    // is filled and drained once (GetBits returns the first byte in the
+    // most significant position)
+    header_word = GetBits(stream, 32);
+    if (header_word != (((BITWORD)UMID_length_byte << 24) | UMID_instance_number)) {
         return CODEC_ERROR_SYNTAX_ERROR;
     }
     
@@ -1118,42 +1305,137 @@ static CODEC_ERROR ParseUniqueImageIdentifier(DECODER *decoder, BITSTREAM *strea
 	@todo Need to check that parameters found in the sample are consistent with
 	the decoding parameters used to initialize the codec state.
  */
-CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segment)
+//! Classification of the chunk tags dispatched by the default arm of
+//! the tag switch in @ref UpdateCodecState
+typedef enum chunk_kind
 {
-    CODEC_ERROR error = CODEC_ERROR_OKAY;
-    CODEC_STATE *codec = &decoder->codec;
-    ENABLED_PARTS enabled_parts = decoder->enabled_parts;
-    bool optional = false;
-    int chunk_size = 0;
-    TAGWORD tag = segment.tuple.tag;
-    TAGWORD value = segment.tuple.value;
-    
-    // The enabled parts variable may not be used depending on the compile-time options
-    (void)enabled_parts;
-    
-    // Assume that the next syntax element is not a tag-value pair for a header parameter
-    codec->header = false;
-    
-    // Assume that the next syntax element is not a codeblock (large chunk element)
-    codec->codeblock = false;
-    
-    // Is this an optional tag?
-    if (tag < 0) {
-        tag = RequiredTag(tag);
-        optional = true;
+    CHUNK_KIND_UNKNOWN = 0,				//!< Not a chunk tag defined by VC-5 Part 1
+    CHUNK_KIND_UNIQUE_IMAGE_IDENTIFIER,
+    CHUNK_KIND_INVERSE_TRANSFORM,
+    CHUNK_KIND_INVERSE_PERMUTATION,
+    CHUNK_KIND_INVERSE_TRANSFORM_16,
+#if VC5_ENABLED_PART(VC5_PART_SECTIONS)
+    CHUNK_KIND_SECTION_HEADER,
+#endif
+} CHUNK_KIND;
+
+/*!
+	@brief Classify a chunk tag for the dispatch in @ref UpdateCodecState
+
+	The classification depends only on the tag, so the dispatch compiles
+	to one multiway branch instead of a chain of compares walked by every
+	unrecognized segment.
+*/
+/*!
+	@brief Update the count of channels whose decoding has finished
+
+	Called after a band in the level one wavelet of the channel becomes
+	valid.  The counter lets @ref IsDecodingComplete answer with a single
+	compare instead of scanning the wavelet trees after every segment.
+ */
+STATIC_INLINE void UpdateChannelCompletion(DECODER *decoder, int channel, WAVELET *wavelet)
+{
+    if (AllBandsValid(wavelet) && !decoder->channel[channel].finished)
+    {
+        decoder->channel[channel].finished = true;
+        decoder->finished_channel_count++;
     }
-    
+}
+
+/*!
+	@brief Set the bit for the specified subband in the decoded band mask
+	The decoded subband mask is used to track which subbands have been
+	decoded in the current channel.  It is reset at the start of each
+	channel.  The update is a single OR executed once per subband, so it
+	is defined inline on the codeblock path.
+ */
+STATIC_INLINE void SetDecodedBandMask(CODEC_STATE *codec, int subband)
+{
+    assert(0 <= subband && subband < MAX_SUBBAND_COUNT);
+    if (0 <= subband && subband < MAX_SUBBAND_COUNT) {
+        codec->decoded_subband_mask |= (1 << subband);
+    }
+}
+
+STATIC_INLINE CHUNK_KIND ClassifyChunkTag(TAGWORD tag)
+{
+    switch (tag)
+    {
+        case CODEC_TAG_UniqueImageIdentifier:
+            return CHUNK_KIND_UNIQUE_IMAGE_IDENTIFIER;
+            
+        case CODEC_TAG_InverseTransform:
+            return CHUNK_KIND_INVERSE_TRANSFORM;
+            
+        case CODEC_TAG_InversePermutation:
+            return CHUNK_KIND_INVERSE_PERMUTATION;
+            
+        case CODEC_TAG_InverseTransform16:
+            return CHUNK_KIND_INVERSE_TRANSFORM_16;
+            
+        default:
+#if VC5_ENABLED_PART(VC5_PART_SECTIONS)
+            if (IsSectionHeader(tag)) {
+                return CHUNK_KIND_SECTION_HEADER;
+            }
+#endif
+            return CHUNK_KIND_UNKNOWN;
+    }
+}
+
+CODEC_ERROR UpdateCodecState(DECODER *restrict decoder, BITSTREAM *restrict stream, TAGVALUE segment)
+{
+    CODEC_ERROR error = CODEC_ERROR_OKAY;
+    CODEC_STATE *codec = &decoder->codec;
+    ENABLED_PARTS enabled_parts = decoder->enabled_parts;
+    bool optional = false;
+    int chunk_size = 0;
+    TAGWORD tag = segment.tuple.tag;
+    TAGWORD value = segment.tuple.value;
+    
+    // The enabled parts variable may not be used depending on the compile-time options
+    (void)enabled_parts;
+    
+    // Assume that the next syntax element is not a tag-value pair for a
+    // header parameter and not a codeblock (large chunk element); the
+    // flags are tracked in locals and the header flag is published to the
+    // codec state once after the tag has been processed
+    bool is_header = false;
+    bool is_codeblock = false;
+#if VC5_ENABLED_PART(VC5_PART_SECTIONS)
+    bool is_header_section = false;
+#endif
+    
+    // Is this an optional tag?
+    if (tag < 0) {
+        tag = RequiredTag(tag);
+        optional = true;
+    }
+    
+    // Codeblocks are by far the most frequent element (one per subband per
+    // channel), so recognize them with one predictable test before the tag
+    // switch instead of speculating through the whole branch tree
+    if ((tag & CODEC_TAG_LargeCodeblock) == CODEC_TAG_LargeCodeblock)
+    {
+        // The chunk size includes the low byte in the tag
+        chunk_size = (value & 0xFFFF);
+        chunk_size += ((tag & 0xFF) << 16);
+        
+        is_codeblock = true;
+    }
+    else
     switch (tag)
     {
         case CODEC_TAG_ChannelCount:		// Number of channels in the transform
             assert(0 < value && value <= MAX_CHANNEL_COUNT);
             codec->channel_count = (uint_least8_t)value;
-            codec->header = true;
+            UpdateInverseComponentPayloadSizes(decoder);
+            is_header = true;
             break;
             
         case CODEC_TAG_ImageWidth:			// Width of the image
             codec->image_width = value;
-            codec->header = true;
+            is_header = true;
             
             // The image width is the default width of the next channel in the bitstream
             codec->channel_width = value;
@@ -1161,7 +1443,7 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
             
         case CODEC_TAG_ImageHeight:			// Height of the image
             codec->image_height = value;
-            codec->header = true;
+            is_header = true;
             
             // The image height is the default height of the next channel in the bitstream
             codec->channel_height = value;
@@ -1200,7 +1482,7 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
             if (IsPartEnabled(enabled_parts, VC5_PART_IMAGE_FORMATS))
             {
                 codec->image_format = (IMAGE_FORMAT)value;
-                codec->header = true;
+                is_header = true;
             }
             else
             {
@@ -1214,7 +1496,11 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
             if (IsPartEnabled(enabled_parts, VC5_PART_IMAGE_FORMATS))
             {
                 codec->pattern_width = (DIMENSION)value;
-                codec->header = true;
+#if VC5_ENABLED_PART(VC5_PART_COLOR_SAMPLING)
+                codec->color_sampled_component_count = (uint8_t)(codec->pattern_width * codec->pattern_height + 2);
+#endif
+                UpdateInverseComponentPayloadSizes(decoder);
+                is_header = true;
             }
             else
             {
@@ -1228,7 +1514,11 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
             if (IsPartEnabled(enabled_parts, VC5_PART_IMAGE_FORMATS))
             {
                 codec->pattern_height = (DIMENSION)value;
-                codec->header = true;
+#if VC5_ENABLED_PART(VC5_PART_COLOR_SAMPLING)
+                codec->color_sampled_component_count = (uint8_t)(codec->pattern_width * codec->pattern_height + 2);
+#endif
+                UpdateInverseComponentPayloadSizes(decoder);
+                is_header = true;
             }
             else
             {
@@ -1242,7 +1532,7 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
             if (IsPartEnabled(enabled_parts, VC5_PART_IMAGE_FORMATS))
             {
                 codec->components_per_sample = (DIMENSION)value;
-                codec->header = true;
+                is_header = true;
             }
             else
             {
@@ -1256,7 +1546,7 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
             if (IsPartEnabled(enabled_parts, VC5_PART_IMAGE_FORMATS))
             {
                 codec->max_bits_per_component = (PRECISION)value;
-                codec->header = true;
+                is_header = true;
             }
             else
             {
@@ -1306,29 +1596,21 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
             // Does this tag indicate a chunk of data?
             if (tag & CODEC_TAG_CHUNK_MASK)
             {
-                // Does this chunk have a 24-bit size?
-                if(tag & CODEC_TAG_LARGE_CHUNK)
-                {
-                    // The chunk size includes the low byte in the tag
-                    chunk_size = (value & 0xFFFF);
-                    chunk_size += ((tag & 0xFF) << 16);
-                }
-                else
-                {
-                    // The chunk size is specified by the value
-                    chunk_size = (value & 0xFFFF);
-                }
-            }
-            
-            // Is this a codeblock?
-            if ((tag & CODEC_TAG_LargeCodeblock) == CODEC_TAG_LargeCodeblock)
-            {
-                codec->codeblock = true;
+                // The chunk size is specified by the value, and a large
+                // chunk extends it with the low byte of the tag as the
+                // high byte.  The extension is selected with a mask
+                // instead of a branch because small and large chunks
+                // interleave in real bitstreams, so the branch would be
+                // unpredictable
+                uint32_t is_large = (tag & CODEC_TAG_LARGE_CHUNK) ? UINT32_MAX : 0;
+                chunk_size = (int)(((uint32_t)value & 0xFFFF) + ((((uint32_t)tag & 0xFF) << 16) & is_large));
             }
             
-            // Is this chunk a unique image identifier?
-            else if (tag == CODEC_TAG_UniqueImageIdentifier)
+            // Dispatch on the chunk tag classification in one multiway
+            // branch (codeblocks were recognized before the switch)
+            switch (ClassifyChunkTag(tag))
             {
+            case CHUNK_KIND_UNIQUE_IMAGE_IDENTIFIER:
                 // The unique image identifier should be optional
                 assert(optional);
                 if (! optional) {
@@ -1337,11 +1619,9 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
                 
                 // Parse the unique image identifier
                 error = ParseUniqueImageIdentifier(decoder, stream, chunk_size);
-            }
-            
-            // Is this chunk an inverse component transform?
-            else if (tag == CODEC_TAG_InverseTransform)
-            {
+                break;
+                
+            case CHUNK_KIND_INVERSE_TRANSFORM:
                 // The inverse component transform should not be optional
                 assert(!optional);
                 if (optional) {
@@ -1349,12 +1629,10 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
                 }
                 
                 // Parse the inverse component transform
-                error = ParseInverseComponentTransform(decoder, stream, chunk_size);
-            }
-            
-            // Is this chunk an inverse component permutation?
-            else if (tag == CODEC_TAG_InversePermutation)
-            {
+                error = ParseInverseComponentTransform(decoder, stream, (uint32_t)chunk_size);
+                break;
+                
+            case CHUNK_KIND_INVERSE_PERMUTATION:
                 // The inverse component permutation should not be optional
                 assert(!optional);
                 if (optional) {
@@ -1362,47 +1640,49 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
                 }
                 
                 // Parse the inverse component permutation
-                error = ParseInverseComponentPermutation(decoder, stream, chunk_size);
-            }
-            
-            // Is this chunk a 16-bit inverse component transform?
-            else if (tag == CODEC_TAG_InverseTransform16)
-            {
+                error = ParseInverseComponentPermutation(decoder, stream, (uint32_t)chunk_size);
+                break;
+                
+            case CHUNK_KIND_INVERSE_TRANSFORM_16:
                 // The 16-bit inverse component transform is not supported
                 assert(0);
                 return CODEC_ERROR_UNIMPLEMENTED;
-            }
-#if VC5_ENABLED_PART(VC5_PART_SECTIONS)
-            // Is this a section header?
-            else if (IsPartEnabled(enabled_parts, VC5_PART_SECTIONS) && decoder->section_flag && IsSectionHeader(tag))
-            {
-                int section_number;
-                
-                // Section headers are optional tag-value pairs
-                optional = true;
                 
-                // Is this a bitstream header section?
-                if (tag == CODEC_TAG_HeaderSectionTag)
-                {
-                    // Handle this tag-value pair as if it was a bitstream header parameter
-                    codec->header = true;
-                }
-                
-                // Convert the tag to a section number
-                GetSectionNumber(tag, &section_number);
-                
-                // Record the section number and length (in segments)
-                codec->section_number = section_number;
-                codec->section_length = chunk_size;
-                
-                if( decoder->section_logfile )
+#if VC5_ENABLED_PART(VC5_PART_SECTIONS)
+            case CHUNK_KIND_SECTION_HEADER:
+                if (IsPartEnabled(enabled_parts, VC5_PART_SECTIONS) && decoder->section_flag)
                 {
-                    // Write the section information to the log file
-                    WriteSectionInformation(decoder->section_logfile, section_number, chunk_size);                    
+                    int section_number;
+                    
+                    // Section headers are optional tag-value pairs
+                    optional = true;
+                    
+                    // Is this a bitstream header section?
+                    if (tag == CODEC_TAG_HeaderSectionTag)
+                    {
+                        // Handle this tag-value pair as if it was a bitstream header parameter
+                        is_header = true;
+                        is_header_section = true;
+                    }
+                    
+                    // Convert the tag to a section number
+                    GetSectionNumber(tag, &section_number);
+                    
+                    // Record the section number and length (in segments)
+                    codec->section_number = section_number;
+                    codec->section_length = chunk_size;
+                    
+                    if( decoder->section_logfile )
+                    {
+                        // Record the section information for the log file
+                        WriteSectionInformation(decoder, section_number, chunk_size);
+                    }
+                    break;
                 }
-            }
+                // Section processing is disabled, so handle the tag as an
+                // unknown chunk (fall through)
 #endif
-            else
+            default:
             {
                 // Does this chunk have a 24-bit chunk payload size?
                 if (tag & CODEC_TAG_LARGE_CHUNK)
@@ -1420,7 +1700,17 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
                 {
                     // Skip processing the payload of this optional chunk element
                     SkipPayload(stream, chunk_size);
+                    
+                    // Apply the effects of the post switch logic directly
+                    // (the segment is not a header parameter and any open
+                    // bitstream header is closed by it) and return instead
+                    // of walking the header and codeblock processing
+                    codec->header = false;
+                    decoder->header_finished = true;
+                    return CODEC_ERROR_OKAY;
                 }
+                break;
+            }
             }
             break;
     }
@@ -1431,33 +1721,32 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
         return error;
     }
     
+    // Publish the header flag for the decoding loop, which tests it to
+    // decide whether the bitstream header is still being parsed
+    codec->header = is_header;
+    
     //TODO: Check that bitstreams with missplaced header parameters fail to decode
     
     //if (IsHeaderParameter(tag))
-    if (codec->header)
+    if (is_header)
     {
         if (optional)
         {
 #if VC5_ENABLED_PART(VC5_PART_SECTIONS)
-            if (tag == CODEC_TAG_HeaderSectionTag)
+            // The section header branch above recorded whether this is an
+            // optional section header tag-value pair, which may appear in
+            // the bitstream header, so the tag is not compared again here
+            if (!is_header_section)
+#endif
             {
-                // Okay for the bitstream header to contain an optional section header tag-value pair
-            }
 #if VC5_ENABLED_PART(VC5_PART_LAYERS)
-            else if (!IsPartEnabled(enabled_parts, VC5_PART_LAYERS))
-            {
-                // A header parameter cannot be optional
-                error =  CODEC_ERROR_REQUIRED_PARAMETER;
-            }
-#endif
+                if (!IsPartEnabled(enabled_parts, VC5_PART_LAYERS))
+                {
+                    // A header parameter cannot be optional
+                    error =  CODEC_ERROR_REQUIRED_PARAMETER;
+                }
 #endif
-#if VC5_ENABLED_PART(VC5_PART_LAYERS)
-            if (!IsPartEnabled(enabled_parts, VC5_PART_LAYERS))
-            {
-                // A header parameter cannot be optional
-                error =  CODEC_ERROR_REQUIRED_PARAMETER;
             }
-#endif
         }
         else if (decoder->header_finished)
         {
@@ -1476,31 +1765,36 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
         decoder->header_finished = true;
     }
     
-#if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
-    // The wavelets and buffers can be allocated after the bitstream header has been parsed
-    if (IsPartEnabled(enabled_parts, VC5_PART_IMAGE_FORMATS) &&
-        decoder->header_finished &&
-        !decoder->memory_allocated)
-    {
-        // Allocate space for the wavelet transforms
-        AllocDecoderTransforms(decoder);
-        
-        // Allocate all buffers required for decoding
-        AllocDecoderBuffers(decoder);
-        
-        // Reset the flags in the wavelet transforms
-        PrepareDecoderTransforms(decoder);
-        
-        // The wavelet transforms and decoding buffers have been allocated
-        decoder->memory_allocated = true;
-    }
-#endif
-    
     // Found a codeblock element?
-    if (codec->codeblock)
+    if (is_codeblock)
     {
         const int channel_number = codec->channel_number;
         
+#if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
+        // The wavelets and buffers are allocated once, before the first
+        // codeblock is decoded; testing the flag here instead of on every
+        // segment keeps the check off the common parsing path (the header
+        // is always finished by this point because a codeblock is not a
+        // header parameter)
+        if (!decoder->memory_allocated &&
+            IsPartEnabled(enabled_parts, VC5_PART_IMAGE_FORMATS))
+        {
+            assert(decoder->header_finished);
+            
+            // Allocate space for the wavelet transforms
+            AllocDecoderTransforms(decoder);
+            
+            // Allocate all buffers required for decoding
+            AllocDecoderBuffers(decoder);
+            
+            // Reset the flags in the wavelet transforms
+            PrepareDecoderTransforms(decoder);
+            
+            // The wavelet transforms and decoding buffers have been allocated
+            decoder->memory_allocated = true;
+        }
+#endif
+        
         // Have the channel dimensions been initialized?
         if (!decoder->channel[channel_number].initialized)
         {
@@ -1525,8 +1819,6 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
         }
         
         {
-            CODEC_STATE *codec = &decoder->codec;
-            
             const int subband_number = codec->subband_number;
             
             if( subband_number <  decoder->subbands_to_decode )
@@ -1541,10 +1833,29 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
                 
                 WAVELET* wavelet = decoder->transform[channel_number].wavelet[SubbandWaveletIndex(subband_number)];
                 wavelet->valid_band_mask = 0xF;
+                
+                // Track completion of the level one wavelet for this channel
+                if (SubbandWaveletIndex(subband_number) == 0)
+                {
+                    UpdateChannelCompletion(decoder, channel_number, wavelet);
+                }
             }
             
-            // Set the subband number for the next band expected in the bitstream
-            codec->subband_number++;
+            // Advance to the next band expected in the bitstream, wrapping
+            // to the next channel at the end of the current channel (the
+            // counters are computed in locals and written back once, so the
+            // calls above cannot force reloads between the updates)
+            int next_subband = subband_number + 1;
+            int next_channel = codec->channel_number;
+            
+            if (next_subband == codec->subband_count)
+            {
+                next_channel++;
+                next_subband = 0;
+            }
+            
+            codec->subband_number = (uint16_t)next_subband;
+            codec->channel_number = (uint16_t)next_channel;
             
             // Was the subband successfully decoded?
             if (error == CODEC_ERROR_OKAY)
@@ -1553,15 +1864,25 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
                 SetDecodedBandMask(codec, subband_number);
             }
             
-            // Done decoding all subbands in this channel?
-            if (codec->subband_number == codec->subband_count)
+#if defined(__GNUC__)
+            // The destination band of the next codeblock has not been
+            // touched since it was allocated, so start fetching the first
+            // lines with write intent while the next chunk header is parsed
+            if (codec->channel_number < codec->channel_count &&
+                codec->subband_number < codec->subband_count)
             {
-                // Advance to the next channel
-                codec->channel_number++;
-                
-                // Reset the subband number
-                codec->subband_number = 0;
+                WAVELET *next_wavelet = decoder->transform[codec->channel_number].wavelet[SubbandWaveletIndex(codec->subband_number)];
+                if (next_wavelet != NULL)
+                {
+                    PIXEL *next_band = next_wavelet->data[SubbandBandIndex(codec->subband_number)];
+                    if (next_band != NULL)
+                    {
+                        __builtin_prefetch(next_band, 1, 1);
+                        __builtin_prefetch((uint8_t *)next_band + 64, 1, 1);
+                    }
+                }
             }
+#endif
         }
         
     }
@@ -1569,89 +1890,45 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
     return error;
 }
 
-/*!
-	@brief Return true if the tag corresponds to a bitstream header parameter
- */
-bool IsHeaderParameter(TAGWORD tag)
-{
-    switch (tag)
-    {
-        case CODEC_TAG_ImageWidth:
-        case CODEC_TAG_ImageHeight:
-        case CODEC_TAG_ChannelCount:
-        case CODEC_TAG_SubbandCount:
-            
+//! Header flag for each bitstream header tag, indexed by the tag value
+//! (a zero entry means the tag is not a header parameter)
+static const uint16_t header_mask_table[CODEC_TAG_ComponentsPerSample + 1] = {
+    [CODEC_TAG_ImageWidth] = BITSTREAM_HEADER_FLAGS_IMAGE_WIDTH,
+    [CODEC_TAG_ImageHeight] = BITSTREAM_HEADER_FLAGS_IMAGE_HEIGHT,
+    [CODEC_TAG_ChannelCount] = BITSTREAM_HEADER_FLAGS_CHANNEL_COUNT,
+    [CODEC_TAG_SubbandCount] = BITSTREAM_HEADER_FLAGS_SUBBAND_COUNT,
 #if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
-        case CODEC_TAG_ImageFormat:
-        case CODEC_TAG_PatternWidth:
-        case CODEC_TAG_PatternHeight:
-        case CODEC_TAG_ComponentsPerSample:
-        case CODEC_TAG_MaxBitsPerComponent:
+    [CODEC_TAG_ImageFormat] = BITSTREAM_HEADER_FLAGS_IMAGE_FORMAT,
+    [CODEC_TAG_PatternWidth] = BITSTREAM_HEADER_FLAGS_PATTERN_WIDTH,
+    [CODEC_TAG_PatternHeight] = BITSTREAM_HEADER_FLAGS_PATTERN_HEIGHT,
+    [CODEC_TAG_ComponentsPerSample] = BITSTREAM_HEADER_FLAGS_COMPONENTS_PER_SAMPLE,
+    [CODEC_TAG_MaxBitsPerComponent] = BITSTREAM_HEADER_FLAGS_MAX_BITS_PER_COMPONENT,
 #endif
-            return true;
-            
-        default:
-            return false;
-    }
-}
+};
 
 /*!
 	@brief Return the header mask that corresponds to the header tag
+
+	The mask is a single table load; tags that are not header parameters
+	(including tags outside the table) map to zero.
  */
-uint16_t GetHeaderMask(TAGWORD tag)
+STATIC_INLINE uint16_t GetHeaderMask(TAGWORD tag)
 {
-    uint16_t header_mask = 0;
+    const TAGWORD table_length = (TAGWORD)(sizeof(header_mask_table) / sizeof(header_mask_table[0]));
     
-    switch (tag)
-    {
-        case CODEC_TAG_ImageWidth:
-            header_mask = BITSTREAM_HEADER_FLAGS_IMAGE_WIDTH;
-            break;
-            
-        case CODEC_TAG_ImageHeight:
-            header_mask = BITSTREAM_HEADER_FLAGS_IMAGE_HEIGHT;
-            break;
-            
-        case CODEC_TAG_ChannelCount:
-            header_mask = BITSTREAM_HEADER_FLAGS_CHANNEL_COUNT;
-            break;
-            
-        case CODEC_TAG_SubbandCount:
-            header_mask = BITSTREAM_HEADER_FLAGS_SUBBAND_COUNT;
-            break;
-            
-#if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
-        case CODEC_TAG_ImageFormat:
-            header_mask = BITSTREAM_HEADER_FLAGS_IMAGE_FORMAT;
-            break;
-#endif
-#if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
-        case CODEC_TAG_PatternWidth:
-            header_mask = BITSTREAM_HEADER_FLAGS_PATTERN_WIDTH;
-            break;
-#endif
-#if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
-        case CODEC_TAG_PatternHeight:
-            header_mask = BITSTREAM_HEADER_FLAGS_PATTERN_HEIGHT;
-            break;
-#endif
-#if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
-        case CODEC_TAG_ComponentsPerSample:
-            header_mask = BITSTREAM_HEADER_FLAGS_COMPONENTS_PER_SAMPLE;
-            break;
-#endif
-#if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
-        case CODEC_TAG_MaxBitsPerComponent:
-            header_mask = BITSTREAM_HEADER_FLAGS_MAX_BITS_PER_COMPONENT;
-            break;
-#endif
-            
-        default:
-            assert(0);
-            break;
+    if (! (0 <= tag && tag < table_length)) {
+        return 0;
     }
     
-    return header_mask;
+    return header_mask_table[tag];
+}
+
+/*!
+	@brief Return true if the tag corresponds to a bitstream header parameter
+ */
+STATIC_INLINE bool IsHeaderParameter(TAGWORD tag)
+{
+    return GetHeaderMask(tag) != 0;
 }
 
 /*!
@@ -1661,13 +1938,9 @@ uint16_t GetHeaderMask(TAGWORD tag)
  */
 CODEC_ERROR UpdateHeaderParameter(DECODER *decoder, TAGWORD tag)
 {
-    uint16_t header_mask = 0;
-    
-    if (!IsHeaderParameter(tag)) {
-        return CODEC_ERROR_UNEXPECTED;
-    }
-    
-    header_mask = GetHeaderMask(tag);
+    // One table lookup answers both whether the tag is a header parameter
+    // and which flag records it
+    uint16_t header_mask = GetHeaderMask(tag);
     
     if (header_mask == 0) {
         return CODEC_ERROR_UNEXPECTED;
@@ -1742,6 +2015,9 @@ CODEC_ERROR DecodeChannelSubband(DECODER *decoder, BITSTREAM *input, size_t chun
     // Wavelet containing the band to decode
     WAVELET *wavelet = NULL;
     
+    // Set when the decoded band completes the wavelet
+    bool wavelet_ready = false;
+    
     //TODO: Need to check that the codeblock matches the chunk size
     (void)chunk_size;
     
@@ -1762,8 +2038,8 @@ CODEC_ERROR DecodeChannelSubband(DECODER *decoder, BITSTREAM *input, size_t chun
         error = DecodeHighpassBand(decoder, input, wavelet, band);
         if (error == CODEC_ERROR_OKAY)
         {
-            // Update the wavelet band valid flags
-            UpdateWaveletValidBandMask(wavelet, band);
+            // Update the wavelet band valid flags and check for completion
+            wavelet_ready = MarkBandAndCheckReady(wavelet, band);
         }
         
         // Save the quantization factor
@@ -1788,16 +2064,49 @@ CODEC_ERROR DecodeChannelSubband(DECODER *decoder, BITSTREAM *input, size_t chun
         error = DecodeLowpassBand(decoder, input, wavelet);
         if (error == CODEC_ERROR_OKAY)
         {
-            // Update the wavelet band valid flags
-            UpdateWaveletValidBandMask(wavelet, band);
+            // Update the wavelet band valid flags and check for completion
+            wavelet_ready = MarkBandAndCheckReady(wavelet, band);
         }
     }
     
     // Ready to invert this wavelet to get the lowpass band in the lower wavelet?
-    if (BandsAllValid(wavelet))
+    if (wavelet_ready)
     {
+#if defined(__GNUC__)
+        // Start fetching the first lines of the four source bands and of
+        // the destination lowpass band so the transform setup overlaps
+        // the DRAM fetches instead of stalling on the first rows
+        {
+            int band_index;
+            
+            for (band_index = 0; band_index < MAX_BAND_COUNT; band_index++)
+            {
+                if (wavelet->data[band_index] != NULL)
+                {
+                    __builtin_prefetch(wavelet->data[band_index], 0, 1);
+                    __builtin_prefetch((uint8_t *)wavelet->data[band_index] + 64, 0, 1);
+                }
+            }
+            
+            if (index > 0)
+            {
+                WAVELET *lowpass = decoder->transform[channel_number].wavelet[index - 1];
+                if (lowpass != NULL && lowpass->data[0] != NULL)
+                {
+                    __builtin_prefetch(lowpass->data[0], 1, 1);
+                }
+            }
+        }
+#endif
+        
         // Apply the inverse wavelet transform to reconstruct the lower level wavelet
         error = ReconstructWaveletBand(decoder, channel_number, wavelet, index);
+        
+        // Track completion of the level one wavelet for this channel
+        if (index == 0)
+        {
+            UpdateChannelCompletion(decoder, channel_number, wavelet);
+        }
     }
     
     return error;
@@ -1856,30 +2165,31 @@ CODEC_ERROR ReconstructWaveletBand(DECODER *decoder, int channel, WAVELET *wavel
         // Check that all of the wavelet bands have been decoded
         assert(BandsAllValid(wavelet));
         
-        // Decode the lowpass band in the wavelet one lower level than the input wavelet
+        // Decode the lowpass band in the wavelet one lower level than the input wavelet.
+        // The task writes only the lowpass band of the lower wavelet while the parsing
+        // thread goes on to fill the highpass bands of that wavelet, and the dependence
+        // on the channel transform orders the task after the one that produced the
+        // lowpass band of the input wavelet
+#if VC5_DECODER_TASKS
+        #pragma omp task firstprivate(wavelet, lowpass, prescale) \
+            depend(inout: decoder->transform[channel])
+#endif
         TransformInverseSpatialQuantLowpass(decoder->allocator, wavelet, lowpass, prescale);
         
-        // Update the band valid flags
+        // Update the band valid flags (the parsing thread does the bookkeeping so that
+        // the decoding progress checks do not depend on task completion)
         UpdateWaveletValidBandMask(lowpass, 0);
+        
+        // Track completion of the level one wavelet for this channel
+        if (lowpass_index == 0)
+        {
+            UpdateChannelCompletion(decoder, channel, lowpass);
+        }
     }
     
     return CODEC_ERROR_OKAY;
 }
 
-/*!
-	@brief Set the bit for the specified subband in the decoded band mask
-	The decoded subband mask is used to track which subbands have been
-	decoded in the current channel.  It is reset at the start of each
-	channel.
- */
-CODEC_ERROR SetDecodedBandMask(CODEC_STATE *codec, int subband)
-{
-    if (0 <= subband && subband < MAX_SUBBAND_COUNT) {
-        codec->decoded_subband_mask |= (1 << subband);
-    }
-    return CODEC_ERROR_OKAY;
-}
-
 /*!
 	@brief Decoded the lowpass band from the bitstream
 	The wavelet at the highest level is passes as an argument.
@@ -1907,23 +2217,98 @@ CODEC_ERROR DecodeLowpassBand(DECODER *decoder, BITSTREAM *stream, WAVELET *wave
     
     lowpass_precision = codec->lowpass_precision;
     
-    // Decode each row in the lowpass image
-    for (row = 0; row < lowpass_band_height; row++)
+    // The lowpass coefficients are fixed size fields packed back to back,
+    // so when the bit buffer is empty and the whole payload is resident in
+    // a memory stream the fields can be extracted from a local 64-bit
+    // accumulator instead of paying the bit buffer bookkeeping in GetBits
+    // for every coefficient
+    if (stream->count == 0 &&
+        stream->stream->cur != NULL &&
+        0 < lowpass_precision && lowpass_precision <= 16 &&
+        ((size_t)lowpass_band_width * lowpass_band_height * lowpass_precision + 7) / 8 <= RemainingStreamBytes(stream->stream))
     {
-        for (column = 0; column < lowpass_band_width; column++)
+        const size_t total_bits = (size_t)lowpass_band_width * lowpass_band_height * lowpass_precision;
+        const uint8_t *src = stream->stream->cur;
+        const uint8_t *src_end = stream->stream->end;
+        const int shift = 64 - lowpass_precision;
+        
+        uint64_t bit_buffer = 0;
+        int bit_count = 0;
+        
+        // The coefficients are packed back to back in the bitstream, so
+        // when the band rows are contiguous the row structure is
+        // irrelevant to the unpack and the band is filled as one linear
+        // extent, removing the per row pointer update from the hot loop
+        const int row_height = (lowpass_band_pitch == lowpass_band_width) ? 1 : lowpass_band_height;
+        const int row_width = (lowpass_band_pitch == lowpass_band_width) ?
+            lowpass_band_width * lowpass_band_height : lowpass_band_width;
+        
+        if (lowpass_precision == 16)
         {
-            COEFFICIENT lowpass_value = (COEFFICIENT)GetBits(stream, lowpass_precision);
-            //assert(0 <= lowpass_value && lowpass_value <= COEFFICIENT_MAX);
-            
-            //if (lowpass_value > COEFFICIENT_MAX) {
-            //	lowpass_value = COEFFICIENT_MAX;
-            //}
+            // Coefficients at the default precision are whole big endian
+            // 16-bit values, so each row is a byte swapping copy that the
+            // compiler can lower to wide shuffles and stores
+            for (row = 0; row < row_height; row++)
+            {
+                for (column = 0; column < row_width; column++)
+                {
+                    lowpass_band_ptr[column] = (COEFFICIENT)((src[0] << 8) | src[1]);
+                    src += 2;
+                }
+                
+                // Advance to the next row in the lowpass image
+                lowpass_band_ptr += lowpass_band_pitch;
+            }
+        }
+        else
+        for (row = 0; row < row_height; row++)
+        {
+            for (column = 0; column < row_width; column++)
+            {
+                if (bit_count < lowpass_precision)
+                {
+                    // Refill the accumulator a byte at a time (the end
+                    // check only matters for the tail of the stream)
+                    do {
+                        bit_buffer |= (uint64_t)(*src++) << (56 - bit_count);
+                        bit_count += 8;
+                    } while (bit_count <= 56 && src < src_end);
+                }
+                
+                lowpass_band_ptr[column] = (COEFFICIENT)(bit_buffer >> shift);
+                bit_buffer <<= lowpass_precision;
+                bit_count -= lowpass_precision;
+            }
             
-            lowpass_band_ptr[column] = lowpass_value;
+            // Advance to the next row in the lowpass image
+            lowpass_band_ptr += lowpass_band_pitch;
         }
         
-        // Advance to the next row in the lowpass image
-        lowpass_band_ptr += lowpass_band_pitch;
+        // Resynchronize the stream with the bits actually consumed: the
+        // whole bytes advance the stream position and any residual bits
+        // are drained through the bit buffer
+        SkipBytes(stream->stream, total_bits / 8);
+        if ((total_bits % 8) != 0)
+        {
+            GetBits(stream, (BITCOUNT)(total_bits % 8));
+        }
+    }
+    else
+    {
+        // Decode each row in the lowpass image
+        for (row = 0; row < lowpass_band_height; row++)
+        {
+            for (column = 0; column < lowpass_band_width; column++)
+            {
+                COEFFICIENT lowpass_value = (COEFFICIENT)GetBits(stream, lowpass_precision);
+                //assert(0 <= lowpass_value && lowpass_value <= COEFFICIENT_MAX);
+                
+                lowpass_band_ptr[column] = lowpass_value;
+            }
+            
+            // Advance to the next row in the lowpass image
+            lowpass_band_ptr += lowpass_band_pitch;
+        }
     }
     // Align the bitstream to the next tag value pair
     AlignBitsSegment(stream);
@@ -1988,8 +2373,100 @@ CODEC_ERROR DecodeHighpassBand(DECODER *decoder, BITSTREAM *stream, WAVELET *wav
 	Special codewords in the codebook have a run length of zero.
 	The value indicates the type or purpose of the special codeword.
  */
-CODEC_ERROR DecodeBandRuns(BITSTREAM *stream, CODEBOOK *codebook, PIXEL *data,
-                           DIMENSION width, DIMENSION height, DIMENSION pitch)
+/*!
+	@brief Write one decoded run into the band
+
+	Shared by the fast and bit serial decoding loops in
+	@ref DecodeBandRuns.  The band memory starts out zero (see @ref
+	ZeroWaveletBands), so runs of zeros only advance the position in the
+	band and nonzero codewords store a single pixel.
+
+	The no_padding argument is a compile time constant at every call
+	site: when the rows are contiguous there is no end of row handling
+	at all, so the band is treated as one linear array.
+*/
+STATIC_INLINE void ExpandBandRun(PIXEL *restrict data, DIMENSION width, size_t row_padding,
+                                 RUN *restrict run, int *index_inout, int *column_inout,
+                                 int *row_inout, size_t *data_count_inout,
+                                 const bool no_padding)
+{
+    int index = *index_inout;
+    int column = *column_inout;
+    int row = *row_inout;
+    
+    if (no_padding)
+    {
+        // The rows are contiguous so the run cannot straddle any padding
+        size_t count = run->count;
+        
+        *data_count_inout -= count;
+        run->count = 0;
+        
+        if (run->value == 0)
+        {
+            // The band memory is already zero
+            index += (int)count;
+        }
+        else while (count > 0)
+        {
+            data[index++] = (PIXEL)run->value;
+            count--;
+        }
+        
+        *index_inout = index;
+        return;
+    }
+    
+    if (run->value == 0)
+    {
+        // The band memory is already zero, so the run only advances the
+        // position in the band, skipping the padding of every crossed row
+        size_t count = run->count;
+        size_t new_column = (size_t)column + count;
+        size_t rows_crossed = new_column / width;
+        
+        *data_count_inout -= count;
+        run->count = 0;
+        
+        index += (int)(count + rows_crossed * row_padding);
+        row += (int)rows_crossed;
+        column = (int)(new_column % width);
+    }
+    else while (run->count > 0)
+    {
+        // Reached the end of the column?
+        if (column == width)
+        {
+            // Skip the padding and advance to the next row
+            index += (int)row_padding;
+            row++;
+            column = 0;
+        }
+        
+        data[index++] = (PIXEL)run->value;
+        column++;
+        run->count--;
+        (*data_count_inout)--;
+    }
+    
+    *index_inout = index;
+    *column_inout = column;
+    *row_inout = row;
+}
+
+/*!
+	@brief Decode the runs in a highpass band
+
+	The no_padding argument selects between the specialization for bands
+	with contiguous rows and the general version that fills the padding
+	at the end of each row; it is a compile time constant in each of the
+	wrapper functions so the row handling folds away entirely in the
+	contiguous case.
+*/
+STATIC_INLINE CODEC_ERROR DecodeBandRunsImpl(BITSTREAM *restrict stream, CODEBOOK *restrict codebook,
+                                             PIXEL *restrict data,
+                                             DIMENSION width, DIMENSION height, DIMENSION pitch,
+                                             const bool no_padding)
 {
     CODEC_ERROR error = CODEC_ERROR_OKAY;
     size_t data_count;
@@ -2010,42 +2487,126 @@ CODEC_ERROR DecodeBandRuns(BITSTREAM *stream, CODEBOOK *codebook, PIXEL *data,
     data_count = height * width;
     row_padding = pitch - width;
     
-    while (data_count > 0)
+    // Decode the runs against a local bit accumulator when the payload is
+    // resident in a memory stream.  The coefficients start on a segment
+    // boundary, so the bit buffer is normally empty on entry, and the most
+    // frequent codewords resolve with one load from the fast codebook
+    // table instead of a bit serial walk of the codebook.
+    if (stream->count == 0 && stream->stream->cur != NULL)
     {
-        // Get the next run length and value
-        error = GetRun(stream, codebook, &run);
-        if (error != CODEC_ERROR_OKAY) {
-            return error;
-        }
+        const VLC_FAST_ENTRY *fast_table = GetFastCodebookTable(codebook);
+        const RLV *codebook_entry = (const RLV *)((const uint8_t *)codebook + sizeof(CODEBOOK));
+        const int codebook_length = codebook->length;
         
-        // Check that the run does not extend past the end of the band
-        assert(run.count <= data_count);
+        const uint8_t *src_start = stream->stream->cur;
+        const uint8_t *src_end = stream->stream->end;
+        const uint8_t *src = src_start;
         
-        // Copy the value into the specified number of pixels in the band
-        while (run.count > 0)
+        uint64_t bit_buffer = 0;
+        int bit_count = 0;
+        size_t bits_used;
+        
+        while (data_count > 0)
         {
-            // Reached the end of the column?
-            if (column == width)
+            const VLC_FAST_ENTRY *entry;
+            
+            // Keep the accumulator as full as the stream allows (the
+            // longest codeword with its sign suffix is 27 bits)
+            while (bit_count <= 56 && src < src_end)
+            {
+                bit_buffer |= (uint64_t)(*src++) << (56 - bit_count);
+                bit_count += 8;
+            }
+            
+            entry = &fast_table[bit_buffer >> (64 - VLC_FAST_BITS)];
+            
+            if (entry->size != 0 && (int)entry->size <= bit_count)
             {
-                // Need to pad the end of the row?
-                if (row_padding > 0)
+                run.value = entry->value;
+                run.count = entry->count;
+                bit_buffer <<= entry->size;
+                bit_count -= entry->size;
+            }
+            else
+            {
+                // A codeword longer than the table index: decode it
+                // against the codebook entries directly
+                uint32_t code_size = 0;
+                int entry_index;
+                
+                for (entry_index = 0; entry_index < codebook_length; entry_index++)
                 {
-                    int count;
-                    for (count = 0; (size_t)count < row_padding; count++) {
-                        data[index++] = 0;
+                    uint32_t size = codebook_entry[entry_index].size;
+                    
+                    if (size <= VLC_FAST_BITS || (int)size > bit_count) {
+                        continue;
+                    }
+                    
+                    if ((uint32_t)(bit_buffer >> (64 - size)) == codebook_entry[entry_index].bits)
+                    {
+                        run.count = codebook_entry[entry_index].count;
+                        run.value = codebook_entry[entry_index].value;
+                        code_size = size;
+                        break;
                     }
                 }
                 
-                // Advance to the next row
-                row++;
-                column = 0;
+                if (code_size == 0 || run.count == 0 ||
+                    (run.value != 0 && (int)code_size + VLC_SIGNCODE_SIZE > bit_count))
+                {
+                    // The codeword was not matched, is a special marker, or
+                    // the stream ended inside it: resynchronize and let the
+                    // bit serial loop below handle the remainder
+                    break;
+                }
+                
+                bit_buffer <<= code_size;
+                bit_count -= (int)code_size;
+                
+                if (run.value != 0)
+                {
+                    // Consume the sign suffix that follows the magnitude
+                    if ((uint32_t)(bit_buffer >> 63) == VLC_NEGATIVE_CODE) {
+                        run.value = neg(run.value);
+                    }
+                    bit_buffer <<= VLC_SIGNCODE_SIZE;
+                    bit_count -= VLC_SIGNCODE_SIZE;
+                }
             }
             
-            data[index++] = (PIXEL)run.value;
-            column++;
-            run.count--;
-            data_count--;
+            // Check that the run does not extend past the end of the band
+            assert(run.count <= data_count);
+            
+            // Copy the value into the specified number of pixels in the band
+            ExpandBandRun(data, width, row_padding, &run, &index, &column, &row, &data_count, no_padding);
+        }
+        
+        // Resynchronize the bitstream with the bits actually consumed:
+        // whole bytes advance the stream position and any residual bits
+        // are drained through the bit buffer
+        bits_used = (size_t)(src - src_start) * 8 - (size_t)bit_count;
+        SkipBytes(stream->stream, bits_used / 8);
+        if ((bits_used % 8) != 0)
+        {
+            GetBits(stream, (BITCOUNT)(bits_used % 8));
+        }
+    }
+    
+    // Decode any remaining runs one GetRun call per codeword (file
+    // streams and the rare fallbacks from the accumulator loop)
+    while (data_count > 0)
+    {
+        // Get the next run length and value
+        error = GetRun(stream, codebook, &run);
+        if (error != CODEC_ERROR_OKAY) {
+            return error;
         }
+        
+        // Check that the run does not extend past the end of the band
+        assert(run.count <= data_count);
+        
+        // Copy the value into the specified number of pixels in the band
+        ExpandBandRun(data, width, row_padding, &run, &index, &column, &row, &data_count, no_padding);
     }
     
     // The last run should have ended at the end of the band
@@ -2062,6 +2623,16 @@ CODEC_ERROR DecodeBandRuns(BITSTREAM *stream, CODEBOOK *codebook, PIXEL *data,
     return error;
 }
 
+CODEC_ERROR DecodeBandRuns(BITSTREAM *stream, CODEBOOK *codebook, PIXEL *data,
+                           DIMENSION width, DIMENSION height, DIMENSION pitch)
+{
+    // Select the specialization for the band layout once per band
+    if (pitch == (DIMENSION)(width * sizeof(PIXEL))) {
+        return DecodeBandRunsImpl(stream, codebook, data, width, height, pitch, true);
+    }
+    return DecodeBandRunsImpl(stream, codebook, data, width, height, pitch, false);
+}
+
 /*!
 	@brief Decode the band trailer that follows a highpass band
 	This routine aligns the bitstream to a tag value boundary.
@@ -2130,22 +2701,10 @@ bool IsHeaderComplete(DECODER *decoder)
  */
 bool IsDecodingComplete(DECODER *decoder)
 {
-    int channel_count = decoder->codec.channel_count;
-    int channel_index;
-    
-    for (channel_index = 0; channel_index < channel_count; channel_index++)
-    {
-        WAVELET *wavelet = decoder->transform[channel_index].wavelet[0];
-        
-        // Processing is not complete if the wavelet has not been allocated
-        if (wavelet == NULL) return false;
-        
-        // Processing is not complete unless all bands have been processed
-        if (!AllBandsValid(wavelet)) return false;
-    }
-    
-    // All bands in all wavelets in all channels are done
-    return true;
+    // The per channel completion flags are maintained as the level one
+    // wavelet bands become valid (see @ref UpdateChannelCompletion), so
+    // the answer is a single compare instead of a scan of every channel
+    return (decoder->finished_channel_count == decoder->codec.channel_count);
 }
 
 /*!
@@ -2183,39 +2742,53 @@ CODEC_ERROR ReconstructUnpackedImage(DECODER *decoder, UNPACKED_IMAGE *image)
     image->component_count = 0;
     memset(image->component_array_list, 0, size);
     
+    // Allocate the component array for each channel before the transforms
+    // are started so that the parallel loop below does not depend on the
+    // error handling order
     for (channel_number = 0; channel_number < channel_count; channel_number++)
     {
-        // Get the dimensions of this channel
-        DIMENSION channel_width = decoder->channel[channel_number].width;
-        DIMENSION channel_height = decoder->channel[channel_number].height;
-        PRECISION bits_per_component = decoder->channel[channel_number].bits_per_component;
-        
-        // Amount of prescaling applied to the component array values before encoding
-        PRESCALE prescale = decoder->codec.prescale_table[0];
-        
-        // Allocate the component array for this channel
         error = AllocateComponentArray(allocator,
                                        &image->component_array_list[channel_number],
-                                       channel_width,
-                                       channel_height,
-                                       bits_per_component);
+                                       decoder->channel[channel_number].width,
+                                       decoder->channel[channel_number].height,
+                                       decoder->channel[channel_number].bits_per_component);
         
         if (error != CODEC_ERROR_OKAY) {
             return error;
         }
+    }
+    
+    // Each channel has its own wavelet pyramid and writes its own component
+    // array (the scratch rows used by the transform are allocated per call),
+    // so the channels can be reconstructed on separate cores
+#if defined(GPR_USE_OPENMP)
+    #pragma omp parallel for schedule(static)
+#endif
+    for (channel_number = 0; channel_number < channel_count; channel_number++)
+    {
+        // Get the dimensions of this channel
+        DIMENSION channel_width = decoder->channel[channel_number].width;
+        DIMENSION channel_height = decoder->channel[channel_number].height;
         
-        error = TransformInverseSpatialQuantArray(allocator,
-                                                  decoder->transform[channel_number].wavelet[0],
-                                                  image->component_array_list[channel_number].data,
-                                                  channel_width,
-                                                  channel_height,
-                                                  image->component_array_list[channel_number].pitch,
-                                                  prescale);
-        if (error != CODEC_ERROR_OKAY) {
-            return error;
+        // Amount of prescaling applied to the component array values before encoding
+        PRESCALE prescale = decoder->codec.prescale_table[0];
+        
+        CODEC_ERROR channel_error = TransformInverseSpatialQuantArray(allocator,
+                                                                      decoder->transform[channel_number].wavelet[0],
+                                                                      image->component_array_list[channel_number].data,
+                                                                      channel_width,
+                                                                      channel_height,
+                                                                      image->component_array_list[channel_number].pitch,
+                                                                      prescale);
+        if (channel_error != CODEC_ERROR_OKAY) {
+            error = channel_error;
         }
     }
     
+    if (error != CODEC_ERROR_OKAY) {
+        return error;
+    }
+    
     // One component array is output by the decoding process per channel in the bitstream
     image->component_count = channel_count;
     
@@ -36,9 +36,6 @@
 	
 	@todo Remove unused substructures
  
-	@todo Dynamically allocate the vector of wavelet trees based on the
-	actual number of channels rather than the maximum channel count.
-	
 	@todo Need to handle the cases where header parameters are provided
 	by the application instead of being in the bitstream.
  */
@@ -72,8 +69,29 @@ typedef struct _decoder
         
         bool found_first_codeblock;     //!< Has the first codeblock in the channel been found?
         
+        //! True if the level one wavelet in this channel is fully decoded
+        bool finished;
+        
     } channel[MAX_CHANNEL_COUNT];	//!< Information about each channel in the bitstream
     
+    //! Number of channels whose level one wavelet is fully decoded (see
+    //! @ref IsDecodingComplete)
+    int finished_channel_count;
+    
+    //! Wavelet tree for each channel, allocated on first use and sized
+    //! to the actual channel count (see @ref AllocateTransformArray)
+    TRANSFORM *transform;
+    
+    //! Number of channels in the allocated transform array
+    int transform_count;
+    
+    //! Pointer to the active codebook for variable-length codes
+    CODEBOOK *codebook;
+    
+    int wavelet_count;			//!< Number of wavelets in each channel
+    
+    int subbands_to_decode;
+    
 #if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
     //! Dimensions and format of the encoded image
     struct _encoded
@@ -122,15 +140,14 @@ typedef struct _decoder
     int layer_count;			//!< Number of subsamples in each sample
 #endif
     
-    int wavelet_count;			//!< Number of wavelets in each channel
-    
-    int subbands_to_decode;
-    
-    //! Wavelet tree for each channel
-    TRANSFORM transform[MAX_CHANNEL_COUNT];
+    //! True if the full resolution component arrays must be reconstructed
+    //! (computed once from the requested RGB resolution in @ref PrepareDecoder)
+    bool reconstruct_unpacked;
     
-    //! Pointer to the active codebook for variable-length codes
-    CODEBOOK *codebook;
+    //! Cached payload sizes (in bytes) of the inverse component transform
+    //! and permutation chunks (see @ref UpdateInverseComponentPayloadSizes)
+    size_t inverse_transform_payload;
+    size_t inverse_permutation_payload;
     
 #if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
     uint8_t image_sequence_identifier[16];      //!< UUID for the unique image sequence identifier
@@ -145,6 +162,17 @@ typedef struct _decoder
 #if VC5_ENABLED_PART(VC5_PART_SECTIONS)
     bool section_flag;          //!< Control whether section processing is enabled
     FILE *section_logfile;      //!< Log file for writing section information
+    
+    //! Section records buffered for the log file so the hot parsing path
+    //! stores two integers per section instead of formatting and locking
+    //! the stream (flushed when the buffer fills and when the decoder is
+    //! released)
+    struct _section_record
+    {
+        uint16_t number;        //!< Section number
+        uint32_t length;        //!< Section length (in segments)
+    } section_record[64];
+    int section_record_count;   //!< Number of buffered section records
 #endif
     
 } DECODER;
@@ -258,9 +286,8 @@ extern "C" {
                                       PACKED_IMAGE *packed_image,
                                       const DECODER_PARAMETERS *parameters);
     
-    CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segment);
+    CODEC_ERROR UpdateCodecState(DECODER *restrict decoder, BITSTREAM *restrict stream, TAGVALUE segment);
     
-    bool IsHeaderParameter(TAGWORD tag);
     
     CODEC_ERROR UpdateHeaderParameter(DECODER *decoder, TAGWORD tag);
     
@@ -297,8 +324,6 @@ extern "C" {
     
     CODEC_ERROR ProcessSampleMarker(DECODER *decoder, BITSTREAM *stream, TAGWORD marker);
     
-    CODEC_ERROR SetDecodedBandMask(CODEC_STATE *codec, int subband);
-    
     CODEC_ERROR DecodeLowpassBand(DECODER *decoder, BITSTREAM *stream, WAVELET *wavelet);
     
     CODEC_ERROR DecodeHighpassBand(DECODER *decoder, BITSTREAM *stream, WAVELET *wavelet, int band);
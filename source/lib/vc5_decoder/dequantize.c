@@ -20,69 +20,181 @@
 
 #include "headers.h"
 
-// Not using midpoint correction in dequantization
-static const int midpoint = 0;
+#if VC5_HAVE_AVX2
+
+#include <immintrin.h>
 
 /*!
-	@brief Dequantize a band with the specified dimensions
+	@brief Dequantize eight widened coefficients
 
-	The companding curve is inverted and the value is multiplied by the
-	quantization value that was used by the encoder to compress the band.
+	The input vector holds eight sign extended 32-bit coefficients.  The
+	cubic companding curve is evaluated in double precision with exactly
+	the same operation order as the scalar code, four lanes at a time, so
+	the rounding matches the scalar path bit for bit.
 */
-CODEC_ERROR DequantizeBandRow16s(PIXEL *input, int width, int quantization, PIXEL *output)
+VC5_TARGET_AVX2
+STATIC_INLINE __m256i DequantizeLanes_AVX2(__m256i v, __m256i quantization)
 {
-	int column;
+    const __m256d scale = _mm256_set1_pd(768.);
+    const __m256d divisor = _mm256_set1_pd(255.*255.*255.);
 
-	// Undo quantization in the entire row
-	for (column = 0; column < width; column++)
-	{
-		int32_t value = input[column];
+    // Fold out the sign (the mask is all ones for negative lanes)
+    __m256i sign = _mm256_srai_epi32(v, 31);
+    __m256i magnitude = _mm256_sub_epi32(_mm256_xor_si256(v, sign), sign);
 
-		// Invert the companding curve (if any)
-		value = UncompandedValue(value);
-
-		// Dequantize the absolute value
-		if (value > 0)
-		{
-			value = (quantization * value) + midpoint;
-		}
-		else if (value < 0)
-		{
-			value = neg(value);
-			value = (quantization * value) + midpoint;
-			value = neg(value);
-		}
-
-		// Store the dequantized coefficient
-		output[column] = ClampPixel(value);
-	}
+    // Invert the companding curve on each half in double precision
+    __m256d d_lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(magnitude));
+    __m256d d_hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(magnitude, 1));
 
-	return CODEC_ERROR_OKAY;
+    d_lo = _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(d_lo, d_lo), d_lo), scale), divisor);
+    d_hi = _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(d_hi, d_hi), d_hi), scale), divisor);
+
+    // Truncate towards zero like the scalar cast and add the magnitude
+    magnitude = _mm256_add_epi32(magnitude,
+        _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(d_lo)),
+                                _mm256_cvttpd_epi32(d_hi), 1));
+
+    // Dequantize the magnitude and restore the sign
+    magnitude = _mm256_mullo_epi32(magnitude, quantization);
+    return _mm256_sub_epi32(_mm256_xor_si256(magnitude, sign), sign);
 }
 
 /*!
-	@brief This function dequantizes the pixel value
+	@brief Dequantize whole vectors of sixteen packed coefficients
 
-	The inverse companding curve is applied to convert the pixel value
-	to its quantized value and then the pixel value is multiplied by
-	the quantization parameter.
+	Returns the number of columns processed; the caller finishes the
+	remaining columns with the scalar loop.  The saturating pack performs
+	the same clamp to the pixel range as @ref ClampPixel.
 */
-PIXEL DequantizedValue(int32_t value, int quantization)
+VC5_TARGET_AVX2
+static int DequantizeBandRow16s_AVX2(const PIXEL *input, int width, int quantization, PIXEL *output)
 {
-	// Invert the companding curve (if any)
-	value = UncompandedValue(value);
+    const __m256i quantization_v = _mm256_set1_epi32(quantization);
+    int column;
+
+    for (column = 0; column + 16 <= width; column += 16)
+    {
+        __m256i v_lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(input + column)));
+        __m256i v_hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(input + column + 8)));
 
-	// Dequantize the absolute value
-	if (value > 0)
+        v_lo = DequantizeLanes_AVX2(v_lo, quantization_v);
+        v_hi = DequantizeLanes_AVX2(v_hi, quantization_v);
+
+        _mm256_storeu_si256((__m256i *)(output + column),
+            _mm256_permute4x64_epi64(_mm256_packs_epi32(v_lo, v_hi), 0xD8));
+    }
+
+    return column;
+}
+
+#endif // VC5_HAVE_AVX2
+
+#if ENABLED(NEON) && defined(__aarch64__)
+
+#include <arm_neon.h>
+
+/*!
+	@brief Dequantize four widened coefficients
+
+	NEON counterpart of the AVX2 lane kernel.  The cubic companding curve
+	is evaluated in double precision lanes with exactly the same operation
+	order as the scalar code, so the rounding matches bit for bit; the
+	double precision vector instructions restrict this kernel to AArch64.
+*/
+STATIC_INLINE int32x4_t DequantizeLanes_NEON(int32x4_t v, int32x4_t quantization)
+{
+    const float64x2_t scale = vdupq_n_f64(768.);
+    const float64x2_t divisor = vdupq_n_f64(255.*255.*255.);
+
+    // Fold out the sign (the mask is all ones for negative lanes)
+    int32x4_t sign = vshrq_n_s32(v, 31);
+    int32x4_t magnitude = vsubq_s32(veorq_s32(v, sign), sign);
+
+    // Invert the companding curve on each half in double precision
+    float64x2_t d_lo = vcvtq_f64_s64(vmovl_s32(vget_low_s32(magnitude)));
+    float64x2_t d_hi = vcvtq_f64_s64(vmovl_s32(vget_high_s32(magnitude)));
+
+    d_lo = vdivq_f64(vmulq_f64(vmulq_f64(vmulq_f64(d_lo, d_lo), d_lo), scale), divisor);
+    d_hi = vdivq_f64(vmulq_f64(vmulq_f64(vmulq_f64(d_hi, d_hi), d_hi), scale), divisor);
+
+    // Truncate towards zero like the scalar cast and add the magnitude
+    magnitude = vaddq_s32(magnitude,
+        vcombine_s32(vmovn_s64(vcvtq_s64_f64(d_lo)), vmovn_s64(vcvtq_s64_f64(d_hi))));
+
+    // Dequantize the magnitude and restore the sign
+    magnitude = vmulq_s32(magnitude, quantization);
+    return vsubq_s32(veorq_s32(magnitude, sign), sign);
+}
+
+/*!
+	@brief Dequantize whole vectors of eight packed coefficients
+
+	Returns the number of columns processed; the caller finishes the
+	remaining columns with the scalar loop.  The saturating narrow
+	performs the same clamp to the pixel range as @ref ClampPixel.
+*/
+static int DequantizeBandRow16s_NEON(const PIXEL *input, int width, int quantization, PIXEL *output)
+{
+    const int32x4_t quantization_v = vdupq_n_s32(quantization);
+    int column;
+
+    for (column = 0; column + 8 <= width; column += 8)
+    {
+        int16x8_t v = vld1q_s16(input + column);
+
+        int32x4_t v_lo = DequantizeLanes_NEON(vmovl_s16(vget_low_s16(v)), quantization_v);
+        int32x4_t v_hi = DequantizeLanes_NEON(vmovl_s16(vget_high_s16(v)), quantization_v);
+
+        vst1q_s16(output + column, vcombine_s16(vqmovn_s32(v_lo), vqmovn_s32(v_hi)));
+    }
+
+    return column;
+}
+
+#endif // ENABLED(NEON) && defined(__aarch64__)
+
+/*!
+	@brief Dequantize a band with the specified dimensions
+
+	The companding curve is inverted and the value is multiplied by the
+	quantization value that was used by the encoder to compress the band.
+*/
+CODEC_ERROR DequantizeBandRow16s(const PIXEL *restrict input, int width, int quantization, PIXEL *restrict output)
+{
+	int column = 0;
+
+#if VC5_HAVE_AVX2
+	// Dequantize as much of the row as possible sixteen coefficients at a time
+	if (CpuHasAVX2())
 	{
-		value = (quantization * value) + midpoint;
+		column = DequantizeBandRow16s_AVX2(input, width, quantization, output);
 	}
-	else if (value < 0)
+#endif
+
+#if ENABLED(NEON) && defined(__aarch64__)
+	// NEON is architectural on AArch64 so no run time probe is needed
+	column = DequantizeBandRow16s_NEON(input, width, quantization, output);
+#endif
+
+	// Undo quantization in the rest of the row
+	for (; column < width; column++)
 	{
-		value = neg(value);
-		value = (quantization * value) + midpoint;
-		value = neg(value);
+		int32_t value = input[column];
+
+		// The highpass coefficient signs are close to random, so the sign
+		// is folded out with arithmetic instead of a per coefficient branch
+		// (the sign mask is all ones for negative values)
+		int32_t sign = value >> 31;
+		int32_t magnitude = (value ^ sign) - sign;
+
+		// Invert the companding curve (if any) and dequantize the magnitude
+		magnitude = UncompandedMagnitude(magnitude);
+		magnitude = quantization * magnitude;
+
+		// Restore the sign and store the dequantized coefficient
+		value = (magnitude ^ sign) - sign;
+		output[column] = ClampPixel(value);
 	}
 
-	return ClampPixel(value);
+	return CODEC_ERROR_OKAY;
 }
@@ -21,13 +21,37 @@
 #ifndef QUANTIZE_H
 #define QUANTIZE_H
 
+/*!
+	@brief This function dequantizes the pixel value
+
+	The inverse companding curve is applied to convert the pixel value
+	to its quantized value and then the pixel value is multiplied by
+	the quantization parameter.
+
+	Defined in the header so that callers on per pixel paths can inline
+	the arithmetic and propagate a constant quantization value.
+*/
+STATIC_INLINE PIXEL DequantizedValue(int32_t value, int quantization)
+{
+	// Fold out the sign as in @ref DequantizeBandRow16s
+	int32_t sign = value >> 31;
+	int32_t magnitude = (value ^ sign) - sign;
+
+	// Invert the companding curve (if any) and dequantize the magnitude
+	magnitude = UncompandedMagnitude(magnitude);
+	magnitude = quantization * magnitude;
+
+	// Restore the sign
+	value = (magnitude ^ sign) - sign;
+
+	return ClampPixel(value);
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
     
-    CODEC_ERROR DequantizeBandRow16s(PIXEL *input, int width, int quantization, PIXEL *output);
-
-    PIXEL DequantizedValue(int32_t value, int quantization);
+    CODEC_ERROR DequantizeBandRow16s(const PIXEL *input, int width, int quantization, PIXEL *output);
 
 #ifdef __cplusplus
 }
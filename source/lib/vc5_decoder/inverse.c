@@ -21,6 +21,382 @@
 //! Rounding adjustment used by the inverse wavelet transforms
 static const int32_t rounding = 4;
 
+#if VC5_HAVE_AVX2
+
+#include <immintrin.h>
+
+/*!
+	@brief Widen sixteen packed 16-bit coefficients into two 32-bit vectors
+
+	The reconstruction filters accumulate in 32-bit arithmetic like the
+	scalar code, so the coefficients are sign extended before filtering
+	and packed back down with saturation afterwards.
+*/
+VC5_TARGET_AVX2
+STATIC_INLINE void LoadCoefficients16_AVX2(const PIXEL *row, int column, __m256i *lo, __m256i *hi)
+{
+    *lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(row + column)));
+    *hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(row + column + 8)));
+}
+
+/*!
+	@brief Pack two vectors of 32-bit results into sixteen 16-bit pixels
+
+	The saturating pack performs the same clamp to the pixel range as
+	@ref ClampPixel in the scalar code.
+*/
+VC5_TARGET_AVX2
+STATIC_INLINE __m256i PackResults16_AVX2(__m256i lo, __m256i hi)
+{
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+}
+
+/*!
+	@brief Apply the interior vertical reconstruction filter to whole vectors
+
+	Computes the even and odd output rows for one pair of bands using the
+	interior filter formulas from the scalar loop: the off-center rows are
+	differenced, rounded, and divided by eight, then the center row and the
+	highpass correction are applied and the result is divided by two.  The
+	return value is the number of columns processed; the caller finishes
+	the remaining columns with the scalar loop.
+*/
+VC5_TARGET_AVX2
+STATIC_INLINE int InvertVerticalInterior_AVX2(const PIXEL *low0, const PIXEL *low1, const PIXEL *low2,
+                                              const PIXEL *high, PIXEL *even_output, PIXEL *odd_output,
+                                              int width)
+{
+    const __m256i rounding_v = _mm256_set1_epi32(4);
+    int column;
+
+    for (column = 0; column + 16 <= width; column += 16)
+    {
+        __m256i a_lo, a_hi, b_lo, b_hi, c_lo, c_hi, h_lo, h_hi;
+        __m256i t_lo, t_hi, u_lo, u_hi;
+        __m256i even_lo, even_hi, odd_lo, odd_hi;
+
+        LoadCoefficients16_AVX2(low0, column, &a_lo, &a_hi);
+        LoadCoefficients16_AVX2(low1, column, &b_lo, &b_hi);
+        LoadCoefficients16_AVX2(low2, column, &c_lo, &c_hi);
+        LoadCoefficients16_AVX2(high, column, &h_lo, &h_hi);
+
+        // Even filter: ((low0 - low2 + 4) >> 3) + low1, plus the highpass correction
+        t_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(a_lo, c_lo), rounding_v), 3);
+        t_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(a_hi, c_hi), rounding_v), 3);
+        even_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(t_lo, b_lo), h_lo), 1);
+        even_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(t_hi, b_hi), h_hi), 1);
+
+        // Odd filter: ((low2 - low0 + 4) >> 3) + low1, minus the highpass correction
+        u_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(c_lo, a_lo), rounding_v), 3);
+        u_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(c_hi, a_hi), rounding_v), 3);
+        odd_lo = _mm256_srai_epi32(_mm256_sub_epi32(_mm256_add_epi32(u_lo, b_lo), h_lo), 1);
+        odd_hi = _mm256_srai_epi32(_mm256_sub_epi32(_mm256_add_epi32(u_hi, b_hi), h_hi), 1);
+
+        _mm256_storeu_si256((__m256i *)(even_output + column), PackResults16_AVX2(even_lo, even_hi));
+        _mm256_storeu_si256((__m256i *)(odd_output + column), PackResults16_AVX2(odd_lo, odd_hi));
+    }
+
+    return column;
+}
+
+/*!
+	@brief Interleave and store the even and odd horizontal results
+
+	The even results go to the even output columns and the odd results to
+	the odd output columns, so the two packed vectors are interleaved into
+	thirty-two consecutive output pixels.
+*/
+VC5_TARGET_AVX2
+STATIC_INLINE void StoreInterleaved16_AVX2(PIXEL *output, __m256i even, __m256i odd)
+{
+    __m256i lo = _mm256_unpacklo_epi16(even, odd);
+    __m256i hi = _mm256_unpackhi_epi16(even, odd);
+
+    _mm256_storeu_si256((__m256i *)(output + 0), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i *)(output + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+/*!
+	@brief Apply the interior horizontal reconstruction filter to whole vectors
+
+	Vector version of the interior loop in @ref InvertHorizontal16s: the
+	results are divided by two and clamped to fourteen bits.  Processing
+	starts at the first interior column and the return value is the column
+	where the scalar loop should resume.
+*/
+VC5_TARGET_AVX2
+STATIC_INLINE int InvertHorizontalInterior_AVX2(const PIXEL *lowpass, const PIXEL *highpass,
+                                                PIXEL *output, int last_column)
+{
+    const __m256i rounding_v = _mm256_set1_epi32(4);
+    const __m256i limit_v = _mm256_set1_epi16((1 << 14) - 1);
+    const __m256i zero_v = _mm256_setzero_si256();
+    int column = 1;
+
+    for (; column + 16 <= last_column; column += 16)
+    {
+        __m256i a_lo, a_hi, b_lo, b_hi, c_lo, c_hi, h_lo, h_hi;
+        __m256i t_lo, t_hi, u_lo, u_hi;
+        __m256i even_lo, even_hi, odd_lo, odd_hi;
+        __m256i even, odd;
+
+        LoadCoefficients16_AVX2(lowpass, column - 1, &a_lo, &a_hi);
+        LoadCoefficients16_AVX2(lowpass, column, &b_lo, &b_hi);
+        LoadCoefficients16_AVX2(lowpass, column + 1, &c_lo, &c_hi);
+        LoadCoefficients16_AVX2(highpass, column, &h_lo, &h_hi);
+
+        // Even filter: ((lowpass[-1] - lowpass[+1] + 4) >> 3) + lowpass[0], plus the highpass correction
+        t_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(a_lo, c_lo), rounding_v), 3);
+        t_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(a_hi, c_hi), rounding_v), 3);
+        even_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(t_lo, b_lo), h_lo), 1);
+        even_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(t_hi, b_hi), h_hi), 1);
+
+        // Odd filter: ((lowpass[+1] - lowpass[-1] + 4) >> 3) + lowpass[0], minus the highpass correction
+        u_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(c_lo, a_lo), rounding_v), 3);
+        u_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(c_hi, a_hi), rounding_v), 3);
+        odd_lo = _mm256_srai_epi32(_mm256_sub_epi32(_mm256_add_epi32(u_lo, b_lo), h_lo), 1);
+        odd_hi = _mm256_srai_epi32(_mm256_sub_epi32(_mm256_add_epi32(u_hi, b_hi), h_hi), 1);
+
+        // Clamp the packed results to fourteen bits like clamp_uint14
+        even = _mm256_min_epi16(_mm256_max_epi16(PackResults16_AVX2(even_lo, even_hi), zero_v), limit_v);
+        odd = _mm256_min_epi16(_mm256_max_epi16(PackResults16_AVX2(odd_lo, odd_hi), zero_v), limit_v);
+
+        StoreInterleaved16_AVX2(output + 2 * column, even, odd);
+    }
+
+    return column;
+}
+
+/*!
+	@brief Apply the interior horizontal filter with descaling to whole vectors
+
+	Vector version of the interior loop in @ref InvertHorizontalDescale16s:
+	the scaling applied during encoding is removed by a left shift and the
+	results are clamped to the pixel range by the saturating pack.
+*/
+VC5_TARGET_AVX2
+STATIC_INLINE int InvertHorizontalInteriorDescale_AVX2(const PIXEL *lowpass, const PIXEL *highpass,
+                                                       PIXEL *output, int last_column, int descale_shift)
+{
+    const __m256i rounding_v = _mm256_set1_epi32(4);
+    const __m128i shift_v = _mm_cvtsi32_si128(descale_shift);
+    int column = 1;
+
+    for (; column + 16 <= last_column; column += 16)
+    {
+        __m256i a_lo, a_hi, b_lo, b_hi, c_lo, c_hi, h_lo, h_hi;
+        __m256i t_lo, t_hi, u_lo, u_hi;
+        __m256i even_lo, even_hi, odd_lo, odd_hi;
+
+        LoadCoefficients16_AVX2(lowpass, column - 1, &a_lo, &a_hi);
+        LoadCoefficients16_AVX2(lowpass, column, &b_lo, &b_hi);
+        LoadCoefficients16_AVX2(lowpass, column + 1, &c_lo, &c_hi);
+        LoadCoefficients16_AVX2(highpass, column, &h_lo, &h_hi);
+
+        // Even filter with the highpass correction and the descale shift
+        t_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(a_lo, c_lo), rounding_v), 3);
+        t_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(a_hi, c_hi), rounding_v), 3);
+        even_lo = _mm256_sll_epi32(_mm256_add_epi32(_mm256_add_epi32(t_lo, b_lo), h_lo), shift_v);
+        even_hi = _mm256_sll_epi32(_mm256_add_epi32(_mm256_add_epi32(t_hi, b_hi), h_hi), shift_v);
+
+        // Odd filter with the highpass correction and the descale shift
+        u_lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(c_lo, a_lo), rounding_v), 3);
+        u_hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(c_hi, a_hi), rounding_v), 3);
+        odd_lo = _mm256_sll_epi32(_mm256_sub_epi32(_mm256_add_epi32(u_lo, b_lo), h_lo), shift_v);
+        odd_hi = _mm256_sll_epi32(_mm256_sub_epi32(_mm256_add_epi32(u_hi, b_hi), h_hi), shift_v);
+
+        StoreInterleaved16_AVX2(output + 2 * column,
+                                PackResults16_AVX2(even_lo, even_hi),
+                                PackResults16_AVX2(odd_lo, odd_hi));
+    }
+
+    return column;
+}
+
+#endif
+
+#if ENABLED(NEON)
+
+#include <arm_neon.h>
+
+/*!
+	@brief Widen eight packed 16-bit coefficients into two 32-bit vectors
+
+	NEON counterpart of the AVX2 load helper: the reconstruction filters
+	accumulate in 32-bit arithmetic like the scalar code, so the
+	coefficients are sign extended before filtering.
+*/
+STATIC_INLINE void LoadCoefficients8_NEON(const PIXEL *row, int column, int32x4_t *lo, int32x4_t *hi)
+{
+    int16x8_t v = vld1q_s16(row + column);
+    *lo = vmovl_s16(vget_low_s16(v));
+    *hi = vmovl_s16(vget_high_s16(v));
+}
+
+/*!
+	@brief Pack two vectors of 32-bit results into eight 16-bit pixels
+
+	The saturating narrow performs the same clamp to the pixel range as
+	@ref ClampPixel in the scalar code.
+*/
+STATIC_INLINE int16x8_t PackResults8_NEON(int32x4_t lo, int32x4_t hi)
+{
+    return vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+}
+
+/*!
+	@brief Apply the interior vertical reconstruction filter to whole vectors
+
+	NEON version of @ref InvertVerticalInterior_AVX2 processing eight
+	columns per iteration.  The return value is the number of columns
+	processed; the caller finishes the remaining columns with the scalar
+	loop.
+*/
+STATIC_INLINE int InvertVerticalInterior_NEON(const PIXEL *low0, const PIXEL *low1, const PIXEL *low2,
+                                              const PIXEL *high, PIXEL *even_output, PIXEL *odd_output,
+                                              int width)
+{
+    const int32x4_t rounding_v = vdupq_n_s32(4);
+    int column;
+
+    for (column = 0; column + 8 <= width; column += 8)
+    {
+        int32x4_t a_lo, a_hi, b_lo, b_hi, c_lo, c_hi, h_lo, h_hi;
+        int32x4_t t_lo, t_hi, u_lo, u_hi;
+        int32x4_t even_lo, even_hi, odd_lo, odd_hi;
+
+        LoadCoefficients8_NEON(low0, column, &a_lo, &a_hi);
+        LoadCoefficients8_NEON(low1, column, &b_lo, &b_hi);
+        LoadCoefficients8_NEON(low2, column, &c_lo, &c_hi);
+        LoadCoefficients8_NEON(high, column, &h_lo, &h_hi);
+
+        // Even filter: ((low0 - low2 + 4) >> 3) + low1, plus the highpass correction
+        t_lo = vshrq_n_s32(vaddq_s32(vsubq_s32(a_lo, c_lo), rounding_v), 3);
+        t_hi = vshrq_n_s32(vaddq_s32(vsubq_s32(a_hi, c_hi), rounding_v), 3);
+        even_lo = vshrq_n_s32(vaddq_s32(vaddq_s32(t_lo, b_lo), h_lo), 1);
+        even_hi = vshrq_n_s32(vaddq_s32(vaddq_s32(t_hi, b_hi), h_hi), 1);
+
+        // Odd filter: ((low2 - low0 + 4) >> 3) + low1, minus the highpass correction
+        u_lo = vshrq_n_s32(vaddq_s32(vsubq_s32(c_lo, a_lo), rounding_v), 3);
+        u_hi = vshrq_n_s32(vaddq_s32(vsubq_s32(c_hi, a_hi), rounding_v), 3);
+        odd_lo = vshrq_n_s32(vsubq_s32(vaddq_s32(u_lo, b_lo), h_lo), 1);
+        odd_hi = vshrq_n_s32(vsubq_s32(vaddq_s32(u_hi, b_hi), h_hi), 1);
+
+        vst1q_s16(even_output + column, PackResults8_NEON(even_lo, even_hi));
+        vst1q_s16(odd_output + column, PackResults8_NEON(odd_lo, odd_hi));
+    }
+
+    return column;
+}
+
+/*!
+	@brief Interleave and store the even and odd horizontal results
+*/
+STATIC_INLINE void StoreInterleaved8_NEON(PIXEL *output, int16x8_t even, int16x8_t odd)
+{
+    int16x8x2_t pair;
+    pair.val[0] = even;
+    pair.val[1] = odd;
+    vst2q_s16(output, pair);
+}
+
+/*!
+	@brief Apply the interior horizontal reconstruction filter to whole vectors
+
+	NEON version of @ref InvertHorizontalInterior_AVX2: the results are
+	divided by two and clamped to fourteen bits.  Processing starts at the
+	first interior column and the return value is the column where the
+	scalar loop should resume.
+*/
+STATIC_INLINE int InvertHorizontalInterior_NEON(const PIXEL *lowpass, const PIXEL *highpass,
+                                                PIXEL *output, int last_column)
+{
+    const int32x4_t rounding_v = vdupq_n_s32(4);
+    const int16x8_t limit_v = vdupq_n_s16((1 << 14) - 1);
+    const int16x8_t zero_v = vdupq_n_s16(0);
+    int column = 1;
+
+    for (; column + 8 <= last_column; column += 8)
+    {
+        int32x4_t a_lo, a_hi, b_lo, b_hi, c_lo, c_hi, h_lo, h_hi;
+        int32x4_t t_lo, t_hi, u_lo, u_hi;
+        int32x4_t even_lo, even_hi, odd_lo, odd_hi;
+        int16x8_t even, odd;
+
+        LoadCoefficients8_NEON(lowpass, column - 1, &a_lo, &a_hi);
+        LoadCoefficients8_NEON(lowpass, column, &b_lo, &b_hi);
+        LoadCoefficients8_NEON(lowpass, column + 1, &c_lo, &c_hi);
+        LoadCoefficients8_NEON(highpass, column, &h_lo, &h_hi);
+
+        // Even filter: ((lowpass[-1] - lowpass[+1] + 4) >> 3) + lowpass[0], plus the highpass correction
+        t_lo = vshrq_n_s32(vaddq_s32(vsubq_s32(a_lo, c_lo), rounding_v), 3);
+        t_hi = vshrq_n_s32(vaddq_s32(vsubq_s32(a_hi, c_hi), rounding_v), 3);
+        even_lo = vshrq_n_s32(vaddq_s32(vaddq_s32(t_lo, b_lo), h_lo), 1);
+        even_hi = vshrq_n_s32(vaddq_s32(vaddq_s32(t_hi, b_hi), h_hi), 1);
+
+        // Odd filter: ((lowpass[+1] - lowpass[-1] + 4) >> 3) + lowpass[0], minus the highpass correction
+        u_lo = vshrq_n_s32(vaddq_s32(vsubq_s32(c_lo, a_lo), rounding_v), 3);
+        u_hi = vshrq_n_s32(vaddq_s32(vsubq_s32(c_hi, a_hi), rounding_v), 3);
+        odd_lo = vshrq_n_s32(vsubq_s32(vaddq_s32(u_lo, b_lo), h_lo), 1);
+        odd_hi = vshrq_n_s32(vsubq_s32(vaddq_s32(u_hi, b_hi), h_hi), 1);
+
+        // Clamp the packed results to fourteen bits like clamp_uint14
+        even = vminq_s16(vmaxq_s16(PackResults8_NEON(even_lo, even_hi), zero_v), limit_v);
+        odd = vminq_s16(vmaxq_s16(PackResults8_NEON(odd_lo, odd_hi), zero_v), limit_v);
+
+        StoreInterleaved8_NEON(output + 2 * column, even, odd);
+    }
+
+    return column;
+}
+
+/*!
+	@brief Apply the interior horizontal filter with descaling to whole vectors
+
+	NEON version of @ref InvertHorizontalInteriorDescale_AVX2: the scaling
+	applied during encoding is removed by a left shift and the results are
+	clamped to the pixel range by the saturating narrow.
+*/
+STATIC_INLINE int InvertHorizontalInteriorDescale_NEON(const PIXEL *lowpass, const PIXEL *highpass,
+                                                       PIXEL *output, int last_column, int descale_shift)
+{
+    const int32x4_t rounding_v = vdupq_n_s32(4);
+    const int32x4_t shift_v = vdupq_n_s32(descale_shift);
+    int column = 1;
+
+    for (; column + 8 <= last_column; column += 8)
+    {
+        int32x4_t a_lo, a_hi, b_lo, b_hi, c_lo, c_hi, h_lo, h_hi;
+        int32x4_t t_lo, t_hi, u_lo, u_hi;
+        int32x4_t even_lo, even_hi, odd_lo, odd_hi;
+
+        LoadCoefficients8_NEON(lowpass, column - 1, &a_lo, &a_hi);
+        LoadCoefficients8_NEON(lowpass, column, &b_lo, &b_hi);
+        LoadCoefficients8_NEON(lowpass, column + 1, &c_lo, &c_hi);
+        LoadCoefficients8_NEON(highpass, column, &h_lo, &h_hi);
+
+        // Even filter with the highpass correction and the descale shift
+        t_lo = vshrq_n_s32(vaddq_s32(vsubq_s32(a_lo, c_lo), rounding_v), 3);
+        t_hi = vshrq_n_s32(vaddq_s32(vsubq_s32(a_hi, c_hi), rounding_v), 3);
+        even_lo = vshlq_s32(vaddq_s32(vaddq_s32(t_lo, b_lo), h_lo), shift_v);
+        even_hi = vshlq_s32(vaddq_s32(vaddq_s32(t_hi, b_hi), h_hi), shift_v);
+
+        // Odd filter with the highpass correction and the descale shift
+        u_lo = vshrq_n_s32(vaddq_s32(vsubq_s32(c_lo, a_lo), rounding_v), 3);
+        u_hi = vshrq_n_s32(vaddq_s32(vsubq_s32(c_hi, a_hi), rounding_v), 3);
+        odd_lo = vshlq_s32(vsubq_s32(vaddq_s32(u_lo, b_lo), h_lo), shift_v);
+        odd_hi = vshlq_s32(vsubq_s32(vaddq_s32(u_hi, b_hi), h_hi), shift_v);
+
+        StoreInterleaved8_NEON(output + 2 * column,
+                               PackResults8_NEON(even_lo, even_hi),
+                               PackResults8_NEON(odd_lo, odd_hi));
+    }
+
+    return column;
+}
+
+#endif // ENABLED(NEON)
+
 /*!
  @brief Apply the inverse horizontal wavelet transform
  This routine applies the inverse wavelet transform to a row of
@@ -81,6 +457,19 @@ STATIC CODEC_ERROR InvertHorizontal16s(PIXEL *lowpass,            //!< Horizonta
     // Advance to the next input column (second pair of output values)
     column++;
     
+#if VC5_HAVE_AVX2
+    // Process whole vectors of interior columns before the scalar loop
+    if (CpuHasAVX2())
+    {
+        column = InvertHorizontalInterior_AVX2(lowpass, highpass, output, last_column);
+    }
+#endif
+    
+#if ENABLED(NEON)
+    // Process whole vectors of interior columns before the scalar loop
+    column = InvertHorizontalInterior_NEON(lowpass, highpass, output, last_column);
+#endif
+    
     // Process the rest of the columns up to the last column in the row
     for (; column < last_column; column++)
     {
@@ -173,33 +562,25 @@ STATIC CODEC_ERROR InvertHorizontal16s(PIXEL *lowpass,            //!< Horizonta
 }
 
 /*!
- @brief Apply the inverse horizontal wavelet transform
- This routine is similar to @ref InvertHorizontal16s, but a scale factor
- that was applied during encoding is removed from the output values.
+ @brief Body of the inverse horizontal transform with descaling
+
+ The descale shift is passed as a constant by the dispatch wrapper so
+ that each instantiation folds the shift at compile time and the no-op
+ shift disappears from the scalar loop (the same specialization pattern
+ as @ref DecodeBandRuns).
  */
-STATIC CODEC_ERROR InvertHorizontalDescale16s(PIXEL *lowpass, PIXEL *highpass, PIXEL *output,
-                                              DIMENSION input_width, DIMENSION output_width,
-                                              int descale)
+STATIC_INLINE CODEC_ERROR InvertHorizontalDescale16sImpl(PIXEL *lowpass, PIXEL *highpass, PIXEL *output,
+                                                         DIMENSION input_width, DIMENSION output_width,
+                                                         const int descale_shift)
 {
     const int last_column = input_width - 1;
     
     // Start processing at the beginning of the row
     int column = 0;
     
-    int descale_shift = 0;
-    
     int32_t even;
     int32_t odd;
     
-    /*
-     The implementation of the inverse filter includes descaling by a factor of two
-     because the last division by two in the computation of the even and odd results
-     that is performed using a right arithmetic shift has been omitted from the code.
-     */
-    if (descale == 2) {
-        descale_shift = 1;
-    }
-    
     // Check that the descaling value is reasonable
     assert(descale_shift >= 0);
     
@@ -245,6 +626,19 @@ STATIC CODEC_ERROR InvertHorizontalDescale16s(PIXEL *lowpass, PIXEL *highpass, P
     // Advance to the next input column (second pair of output values)
     column++;
     
+#if VC5_HAVE_AVX2
+    // Process whole vectors of interior columns before the scalar loop
+    if (CpuHasAVX2())
+    {
+        column = InvertHorizontalInteriorDescale_AVX2(lowpass, highpass, output, last_column, descale_shift);
+    }
+#endif
+    
+#if ENABLED(NEON)
+    // Process whole vectors of interior columns before the scalar loop
+    column = InvertHorizontalInteriorDescale_NEON(lowpass, highpass, output, last_column, descale_shift);
+#endif
+    
     // Process the rest of the columns up to the last column in the row
     for (; column < last_column; column++)
     {
@@ -341,6 +735,27 @@ STATIC CODEC_ERROR InvertHorizontalDescale16s(PIXEL *lowpass, PIXEL *highpass, P
     return CODEC_ERROR_OKAY;
 }
 
+/*!
+ @brief Apply the inverse horizontal wavelet transform
+ This routine is similar to @ref InvertHorizontal16s, but a scale factor
+ that was applied during encoding is removed from the output values.
+ */
+STATIC CODEC_ERROR InvertHorizontalDescale16s(PIXEL *lowpass, PIXEL *highpass, PIXEL *output,
+                                              DIMENSION input_width, DIMENSION output_width,
+                                              int descale)
+{
+    /*
+     The implementation of the inverse filter includes descaling by a factor of two
+     because the last division by two in the computation of the even and odd results
+     that is performed using a right arithmetic shift has been omitted from the code.
+     */
+    if (descale == 2) {
+        return InvertHorizontalDescale16sImpl(lowpass, highpass, output, input_width, output_width, 1);
+    }
+    
+    return InvertHorizontalDescale16sImpl(lowpass, highpass, output, input_width, output_width, 0);
+}
+
 /*!
 	@brief Apply the inverse spatial wavelet filter
 	Dequantize the coefficients in the highpass bands and apply the
@@ -385,6 +800,8 @@ CODEC_ERROR InvertSpatialQuant16s(gpr_allocator *allocator,
     PIXEL *odd_highpass;
     PIXEL *even_output;
     PIXEL *odd_output;
+    char *line_buffer;
+    char *line_base;
     size_t buffer_row_size;
     int last_row = input_height - 1;
     int row, column;
@@ -400,21 +817,29 @@ CODEC_ERROR InvertSpatialQuant16s(gpr_allocator *allocator,
     QUANT highhigh_quantization = quantization[HH_BAND];
     
     // Compute positions within the temporary buffer for each row of horizontal lowpass
-    // and highpass intermediate coefficients computed by the vertical inverse transform
-    buffer_row_size = input_width * sizeof(PIXEL);
+    // and highpass intermediate coefficients computed by the vertical inverse transform.
+    // The nine scratch rows are the entire resident working set of the row-streamed
+    // transform, so they are carved from one contiguous allocation with each row
+    // aligned to a cache line to keep the whole set in a compact span of the cache
+    buffer_row_size = (input_width * sizeof(PIXEL) + 63) & ~(size_t)63;
+    
+    line_buffer = (char *)allocator->Alloc(9 * buffer_row_size + 63);
+    
+    // Round the base up to a cache line so every scratch row is aligned
+    line_base = (char *)(((uintptr_t)line_buffer + 63) & ~(uintptr_t)63);
     
     // Compute the positions of the even and odd rows of coefficients
-    even_lowpass = (PIXEL *)allocator->Alloc(buffer_row_size);
-    even_highpass = (PIXEL *)allocator->Alloc(buffer_row_size);
-    odd_lowpass = (PIXEL *)allocator->Alloc(buffer_row_size);
-    odd_highpass = (PIXEL *)allocator->Alloc(buffer_row_size);
+    even_lowpass = (PIXEL *)(line_base + 0 * buffer_row_size);
+    even_highpass = (PIXEL *)(line_base + 1 * buffer_row_size);
+    odd_lowpass = (PIXEL *)(line_base + 2 * buffer_row_size);
+    odd_highpass = (PIXEL *)(line_base + 3 * buffer_row_size);
     
     // Compute the positions of the dequantized highpass rows
-    lowhigh_line[0] = (PIXEL *)allocator->Alloc(buffer_row_size);
-    lowhigh_line[1] = (PIXEL *)allocator->Alloc(buffer_row_size);
-    lowhigh_line[2] = (PIXEL *)allocator->Alloc(buffer_row_size);
-    highlow_line = (PIXEL *)allocator->Alloc(buffer_row_size);
-    highhigh_line = (PIXEL *)allocator->Alloc(buffer_row_size);
+    lowhigh_line[0] = (PIXEL *)(line_base + 4 * buffer_row_size);
+    lowhigh_line[1] = (PIXEL *)(line_base + 5 * buffer_row_size);
+    lowhigh_line[2] = (PIXEL *)(line_base + 6 * buffer_row_size);
+    highlow_line = (PIXEL *)(line_base + 7 * buffer_row_size);
+    highhigh_line = (PIXEL *)(line_base + 8 * buffer_row_size);
     
     // Convert pitch from bytes to pixels
     lowlow_pitch /= sizeof(PIXEL);
@@ -539,84 +964,132 @@ CODEC_ERROR InvertSpatialQuant16s(gpr_allocator *allocator,
     // Process the middle rows using the interior reconstruction filters
     for (; row < last_row; row++)
     {
+#if defined(__GNUC__)
+        // Warm the band rows needed by the next iteration while this row
+        // computes (the first line of each row covers the TLB and starts
+        // the hardware prefetcher on the new page)
+        __builtin_prefetch(lowlow + 3 * lowlow_pitch, 0, 1);
+        __builtin_prefetch(lowhigh + 3 * lowhigh_pitch, 0, 1);
+        __builtin_prefetch(highlow + highlow_pitch, 0, 1);
+        __builtin_prefetch(highhigh + highhigh_pitch, 0, 1);
+#endif
+        
         // Dequantize one row from each of the two highpass bands
         DequantizeBandRow16s(highlow, input_width, highlow_quantization, highlow_line);
         DequantizeBandRow16s(highhigh, input_width, highhigh_quantization, highhigh_line);
         
         // Process the entire row
-        for (column = 0; column < input_width; column++)
+        column = 0;
+        
+#if VC5_HAVE_AVX2
+        // Process whole vectors of columns in both pairs of bands
+        if (CpuHasAVX2())
+        {
+            column = InvertVerticalInterior_AVX2(lowlow, lowlow + lowlow_pitch, lowlow + 2 * lowlow_pitch,
+                                                 highlow_line, even_lowpass, odd_lowpass, input_width);
+            (void)InvertVerticalInterior_AVX2(lowhigh_line[0], lowhigh_line[1], lowhigh_line[2],
+                                              highhigh_line, even_highpass, odd_highpass, input_width);
+        }
+#endif
+        
+#if ENABLED(NEON)
+        // Process whole vectors of columns in both pairs of bands
+        column = InvertVerticalInterior_NEON(lowlow, lowlow + lowlow_pitch, lowlow + 2 * lowlow_pitch,
+                                             highlow_line, even_lowpass, odd_lowpass, input_width);
+        (void)InvertVerticalInterior_NEON(lowhigh_line[0], lowhigh_line[1], lowhigh_line[2],
+                                          highhigh_line, even_highpass, odd_highpass, input_width);
+#endif
+        
+        // Hoist the three vertically adjacent lowpass rows out of the column
+        // loop so the subscripts are plain row indexing
+        const PIXEL *lowlow0 = lowlow + 0 * lowlow_pitch;
+        const PIXEL *lowlow1 = lowlow + 1 * lowlow_pitch;
+        const PIXEL *lowlow2 = lowlow + 2 * lowlow_pitch;
+        
+        for (; column < input_width; column++)
         {
+            // Load each band value once so the reuse between the even and
+            // odd filters does not depend on alias analysis
+            const int32_t low0 = lowlow0[column];
+            const int32_t low1 = lowlow1[column];
+            const int32_t low2 = lowlow2[column];
+            const int32_t high0 = lowhigh_line[0][column];
+            const int32_t high1 = lowhigh_line[1][column];
+            const int32_t high2 = lowhigh_line[2][column];
+            const int32_t highlow = highlow_line[column];
+            const int32_t highhigh = highhigh_line[column];
+
             int32_t even = 0;		// Result of convolution with even filter
             int32_t odd = 0;		// Result of convolution with odd filter
-            
-            
+
+
             /***** Compute the vertical inverse for the left two bands *****/
-            
+
             // Apply the even reconstruction filter to the lowpass band
-            even += lowlow[column + 0 * lowlow_pitch];
-            even -= lowlow[column + 2 * lowlow_pitch];
+            even += low0;
+            even -= low2;
             even += 4;
             even >>= 3;
-            even += lowlow[column + 1 * lowlow_pitch];
-            
+            even += low1;
+
             // Add the highpass correction
-            even += highlow_line[column];
+            even += highlow;
             even >>= 1;
-            
+
             // The inverse of the left two bands should be a positive number
             //assert(0 <= even && even <= INT16_MAX);
-            
+
             // Place the even result in the even row
             even_lowpass[column] = ClampPixel(even);
-            
+
             // Apply the odd reconstruction filter to the lowpass band
-            odd -= lowlow[column + 0 * lowlow_pitch];
-            odd += lowlow[column + 2 * lowlow_pitch];
+            odd -= low0;
+            odd += low2;
             odd += 4;
             odd >>= 3;
-            odd += lowlow[column + 1 * lowlow_pitch];
-            
+            odd += low1;
+
             // Subtract the highpass correction
-            odd -= highlow_line[column];
+            odd -= highlow;
             odd >>= 1;
-            
+
             // The inverse of the left two bands should be a positive number
             //assert(0 <= odd && odd <= INT16_MAX);
-            
+
             // Place the odd result in the odd row
             odd_lowpass[column] = ClampPixel(odd);
-            
-            
+
+
             /***** Compute the vertical inverse for the right two bands *****/
-            
+
             even = 0;
             odd = 0;
-            
+
             // Apply the even reconstruction filter to the lowpass band
-            even += lowhigh_line[0][column];
-            even -= lowhigh_line[2][column];
+            even += high0;
+            even -= high2;
             even += 4;
             even >>= 3;
-            even += lowhigh_line[1][column];
-            
+            even += high1;
+
             // Add the highpass correction
-            even += highhigh_line[column];
+            even += highhigh;
             even >>= 1;
-            
+
             // Place the even result in the even row
             even_highpass[column] = ClampPixel(even);
-            
+
             // Apply the odd reconstruction filter to the lowpass band
-            odd -= lowhigh_line[0][column];
-            odd += lowhigh_line[2][column];
+            odd -= high0;
+            odd += high2;
             odd += 4;
             odd >>= 3;
-            odd += lowhigh_line[1][column];
-            
+            odd += high1;
+
             // Subtract the highpass correction
-            odd -= highhigh_line[column];
+            odd -= highhigh;
             odd >>= 1;
-            
+
             // Place the odd result in the odd row
             odd_highpass[column] = ClampPixel(odd);
         }
@@ -755,16 +1228,7 @@ CODEC_ERROR InvertSpatialQuant16s(gpr_allocator *allocator,
     }
     
     // Free the scratch buffers
-    allocator->Free(even_lowpass);
-    allocator->Free(even_highpass);
-    allocator->Free(odd_lowpass);
-    allocator->Free(odd_highpass);
-    
-    allocator->Free(lowhigh_line[0]);
-    allocator->Free(lowhigh_line[1]);
-    allocator->Free(lowhigh_line[2]);
-    allocator->Free(highlow_line);
-    allocator->Free(highhigh_line);
+    allocator->Free(line_buffer);
     
     return CODEC_ERROR_OKAY;
 }
@@ -795,6 +1259,8 @@ CODEC_ERROR InvertSpatialQuantDescale16s(gpr_allocator *allocator,
     PIXEL *odd_highpass;
     PIXEL *even_output;
     PIXEL *odd_output;
+    char *line_buffer;
+    char *line_base;
     size_t buffer_row_size;
     int last_row = input_height - 1;
     int row, column;
@@ -811,20 +1277,27 @@ CODEC_ERROR InvertSpatialQuantDescale16s(gpr_allocator *allocator,
     
     // Compute positions within the temporary buffer for each row of horizontal lowpass
     // and highpass intermediate coefficients computed by the vertical inverse transform
-    buffer_row_size = input_width * sizeof(PIXEL);
+    buffer_row_size = (input_width * sizeof(PIXEL) + 63) & ~(size_t)63;
+    
+    // Allocate one contiguous cache line aligned block for the nine scratch
+    // rows (see the explanation in @ref InvertSpatialQuant16s)
+    line_buffer = (char *)allocator->Alloc(9 * buffer_row_size + 63);
     
-    // Allocate space for the even and odd rows of results from the inverse vertical filter
-    even_lowpass = (PIXEL *)allocator->Alloc(buffer_row_size);
-    even_highpass = (PIXEL *)allocator->Alloc(buffer_row_size);
-    odd_lowpass = (PIXEL *)allocator->Alloc(buffer_row_size);
-    odd_highpass = (PIXEL *)allocator->Alloc(buffer_row_size);
+    // Round the base up to a cache line so every scratch row is aligned
+    line_base = (char *)(((uintptr_t)line_buffer + 63) & ~(uintptr_t)63);
     
-    // Allocate scratch space for the dequantized highpass coefficients
-    lowhigh_line[0] = (PIXEL *)allocator->Alloc(buffer_row_size);
-    lowhigh_line[1] = (PIXEL *)allocator->Alloc(buffer_row_size);
-    lowhigh_line[2] = (PIXEL *)allocator->Alloc(buffer_row_size);
-    highlow_line = (PIXEL *)allocator->Alloc(buffer_row_size);
-    highhigh_line = (PIXEL *)allocator->Alloc(buffer_row_size);
+    // Compute the positions of the even and odd rows of results from the inverse vertical filter
+    even_lowpass = (PIXEL *)(line_base + 0 * buffer_row_size);
+    even_highpass = (PIXEL *)(line_base + 1 * buffer_row_size);
+    odd_lowpass = (PIXEL *)(line_base + 2 * buffer_row_size);
+    odd_highpass = (PIXEL *)(line_base + 3 * buffer_row_size);
+    
+    // Compute the positions of the dequantized highpass rows
+    lowhigh_line[0] = (PIXEL *)(line_base + 4 * buffer_row_size);
+    lowhigh_line[1] = (PIXEL *)(line_base + 5 * buffer_row_size);
+    lowhigh_line[2] = (PIXEL *)(line_base + 6 * buffer_row_size);
+    highlow_line = (PIXEL *)(line_base + 7 * buffer_row_size);
+    highhigh_line = (PIXEL *)(line_base + 8 * buffer_row_size);
     
     // Convert pitch from bytes to pixels
     lowlow_pitch /= sizeof(PIXEL);
@@ -952,84 +1425,132 @@ CODEC_ERROR InvertSpatialQuantDescale16s(gpr_allocator *allocator,
     // Process the middle rows using the interior reconstruction filters
     for (; row < last_row; row++)
     {
+#if defined(__GNUC__)
+        // Warm the band rows needed by the next iteration while this row
+        // computes (the first line of each row covers the TLB and starts
+        // the hardware prefetcher on the new page)
+        __builtin_prefetch(lowlow + 3 * lowlow_pitch, 0, 1);
+        __builtin_prefetch(lowhigh + 3 * lowhigh_pitch, 0, 1);
+        __builtin_prefetch(highlow + highlow_pitch, 0, 1);
+        __builtin_prefetch(highhigh + highhigh_pitch, 0, 1);
+#endif
+        
         // Dequantize one row from each of the two highpass bands
         DequantizeBandRow16s(highlow, input_width, highlow_quantization, highlow_line);
         DequantizeBandRow16s(highhigh, input_width, highhigh_quantization, highhigh_line);
         
         // Process the entire row
-        for (column = 0; column < input_width; column++)
+        column = 0;
+        
+#if VC5_HAVE_AVX2
+        // Process whole vectors of columns in both pairs of bands
+        if (CpuHasAVX2())
+        {
+            column = InvertVerticalInterior_AVX2(lowlow, lowlow + lowlow_pitch, lowlow + 2 * lowlow_pitch,
+                                                 highlow_line, even_lowpass, odd_lowpass, input_width);
+            (void)InvertVerticalInterior_AVX2(lowhigh_line[0], lowhigh_line[1], lowhigh_line[2],
+                                              highhigh_line, even_highpass, odd_highpass, input_width);
+        }
+#endif
+        
+#if ENABLED(NEON)
+        // Process whole vectors of columns in both pairs of bands
+        column = InvertVerticalInterior_NEON(lowlow, lowlow + lowlow_pitch, lowlow + 2 * lowlow_pitch,
+                                             highlow_line, even_lowpass, odd_lowpass, input_width);
+        (void)InvertVerticalInterior_NEON(lowhigh_line[0], lowhigh_line[1], lowhigh_line[2],
+                                          highhigh_line, even_highpass, odd_highpass, input_width);
+#endif
+        
+        // Hoist the three vertically adjacent lowpass rows out of the column
+        // loop so the subscripts are plain row indexing
+        const PIXEL *lowlow0 = lowlow + 0 * lowlow_pitch;
+        const PIXEL *lowlow1 = lowlow + 1 * lowlow_pitch;
+        const PIXEL *lowlow2 = lowlow + 2 * lowlow_pitch;
+        
+        for (; column < input_width; column++)
         {
+            // Load each band value once so the reuse between the even and
+            // odd filters does not depend on alias analysis
+            const int32_t low0 = lowlow0[column];
+            const int32_t low1 = lowlow1[column];
+            const int32_t low2 = lowlow2[column];
+            const int32_t high0 = lowhigh_line[0][column];
+            const int32_t high1 = lowhigh_line[1][column];
+            const int32_t high2 = lowhigh_line[2][column];
+            const int32_t highlow = highlow_line[column];
+            const int32_t highhigh = highhigh_line[column];
+
             int32_t even = 0;		// Result of convolution with even filter
             int32_t odd = 0;		// Result of convolution with odd filter
-            
-            
+
+
             /***** Compute the vertical inverse for the left two bands *****/
-            
+
             // Apply the even reconstruction filter to the lowpass band
-            even += lowlow[column + 0 * lowlow_pitch];
-            even -= lowlow[column + 2 * lowlow_pitch];
+            even += low0;
+            even -= low2;
             even += 4;
             even >>= 3;
-            even += lowlow[column + 1 * lowlow_pitch];
-            
+            even += low1;
+
             // Add the highpass correction
-            even += highlow_line[column];
+            even += highlow;
             even = DivideByShift(even, 1);
-            
+
             // The inverse of the left two bands should be a positive number
             //assert(0 <= even && even <= INT16_MAX);
-            
+
             // Place the even result in the even row
             even_lowpass[column] = ClampPixel(even);
-            
+
             // Apply the odd reconstruction filter to the lowpass band
-            odd -= lowlow[column + 0 * lowlow_pitch];
-            odd += lowlow[column + 2 * lowlow_pitch];
+            odd -= low0;
+            odd += low2;
             odd += 4;
             odd >>= 3;
-            odd += lowlow[column + 1 * lowlow_pitch];
-            
+            odd += low1;
+
             // Subtract the highpass correction
-            odd -= highlow_line[column];
+            odd -= highlow;
             odd = DivideByShift(odd, 1);
-            
+
             // The inverse of the left two bands should be a positive number
             //assert(0 <= odd && odd <= INT16_MAX);
-            
+
             // Place the odd result in the odd row
             odd_lowpass[column] = ClampPixel(odd);
-            
-            
+
+
             /***** Compute the vertical inverse for the right two bands *****/
-            
+
             even = 0;
             odd = 0;
-            
+
             // Apply the even reconstruction filter to the lowpass band
-            even += lowhigh_line[0][column];
-            even -= lowhigh_line[2][column];
+            even += high0;
+            even -= high2;
             even += 4;
             even >>= 3;
-            even += lowhigh_line[1][column];
-            
+            even += high1;
+
             // Add the highpass correction
-            even += highhigh_line[column];
+            even += highhigh;
             even = DivideByShift(even, 1);
-            
+
             // Place the even result in the even row
             even_highpass[column] = ClampPixel(even);
-            
+
             // Apply the odd reconstruction filter to the lowpass band
-            odd -= lowhigh_line[0][column];
-            odd += lowhigh_line[2][column];
+            odd -= high0;
+            odd += high2;
             odd += 4;
             odd >>= 3;
-            odd += lowhigh_line[1][column];
-            
+            odd += high1;
+
             // Subtract the highpass correction
-            odd -= highhigh_line[column];
+            odd -= highhigh;
             odd = DivideByShift(odd, 1);
-            
+
             // Place the odd result in the odd row
             odd_highpass[column] = ClampPixel(odd);
         }
@@ -1172,16 +1693,7 @@ CODEC_ERROR InvertSpatialQuantDescale16s(gpr_allocator *allocator,
     }
     
     // Free the scratch buffers
-    allocator->Free(even_lowpass);
-    allocator->Free(even_highpass);
-    allocator->Free(odd_lowpass);
-    allocator->Free(odd_highpass);
-    
-    allocator->Free(lowhigh_line[0]);
-    allocator->Free(lowhigh_line[1]);
-    allocator->Free(lowhigh_line[2]);
-    allocator->Free(highlow_line);
-    allocator->Free(highhigh_line);
+    allocator->Free(line_buffer);
     
     return CODEC_ERROR_OKAY;
 }
@@ -18,17 +18,111 @@
 
 #include "headers.h"
 
+#if defined(GPR_USE_OPENMP)
+#include <omp.h>
+#endif
+
+#if VC5_HAVE_AVX2
+
+#include <immintrin.h>
+
 /*!
-	@brief Pack the component arrays into an output image
+	@brief Pack one row of Bayer components into the BYR4 pattern using AVX2 (eight quads per pass)
+
+	Eight columns of the four component rows are widened to 32-bit lanes,
+	recombined into the Bayer primaries, clamped to the log curve table
+	range and mapped through the table with vector gathers, exactly as the
+	scalar loop in @ref PackComponentsToRAW does one column at a time.
+	Each output half row receives its two primaries as a pair packed into
+	one 32-bit lane, so eight columns store as one 256-bit write per half
+	row.  The format choice is a flag hoisted out of the column loop; the
+	remainder of the row is handled by the scalar loop.
+
+	@return The number of columns packed (a multiple of eight).
+*/
+VC5_TARGET_AVX2
+static int PackBayerComponentsRow_AVX2(const COMPONENT_VALUE *GS_row, const COMPONENT_VALUE *RG_row,
+                                       const COMPONENT_VALUE *BG_row, const COMPONENT_VALUE *GD_row,
+                                       uint16_t *output_row1_ptr, uint16_t *output_row2_ptr,
+                                       int width, int shift, bool rggb)
+{
+    const __m256i zero_epi32 = _mm256_setzero_si256();
+    const __m256i max12_epi32 = _mm256_set1_epi32((1 << 12) - 1);
+    const __m256i mask16_epi32 = _mm256_set1_epi32(0xFFFF);
+    const __m256i midpoint_epi32 = _mm256_set1_epi32(2048);
+    const __m128i shift_count = _mm_cvtsi32_si128(shift);
+
+    const int vector_width = width & ~7;
+    int column;
+
+    for (column = 0; column < vector_width; column += 8)
+    {
+        __m256i row1, row2;
+
+        // Load eight columns of each component and convert to signed values
+        __m256i GS = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(GS_row + column)));
+        __m256i RG = _mm256_sub_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(RG_row + column))), midpoint_epi32);
+        __m256i BG = _mm256_sub_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(BG_row + column))), midpoint_epi32);
+        __m256i GD = _mm256_sub_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(GD_row + column))), midpoint_epi32);
+
+        __m256i R  = _mm256_add_epi32(_mm256_slli_epi32(RG, 1), GS);
+        __m256i B  = _mm256_add_epi32(_mm256_slli_epi32(BG, 1), GS);
+        __m256i G1 = _mm256_add_epi32(GS, GD);
+        __m256i G2 = _mm256_sub_epi32(GS, GD);
+
+        // Clamp the values to 12 bits and apply the inverse protune log curve
+        R  = _mm256_min_epi32(_mm256_max_epi32(R,  zero_epi32), max12_epi32);
+        G1 = _mm256_min_epi32(_mm256_max_epi32(G1, zero_epi32), max12_epi32);
+        G2 = _mm256_min_epi32(_mm256_max_epi32(G2, zero_epi32), max12_epi32);
+        B  = _mm256_min_epi32(_mm256_max_epi32(B,  zero_epi32), max12_epi32);
+
+        R  = _mm256_and_si256(_mm256_i32gather_epi32((const int *)DecoderLogCurve, R,  2), mask16_epi32);
+        G1 = _mm256_and_si256(_mm256_i32gather_epi32((const int *)DecoderLogCurve, G1, 2), mask16_epi32);
+        G2 = _mm256_and_si256(_mm256_i32gather_epi32((const int *)DecoderLogCurve, G2, 2), mask16_epi32);
+        B  = _mm256_and_si256(_mm256_i32gather_epi32((const int *)DecoderLogCurve, B,  2), mask16_epi32);
+
+        R  = _mm256_srl_epi32(R,  shift_count);
+        G1 = _mm256_srl_epi32(G1, shift_count);
+        G2 = _mm256_srl_epi32(G2, shift_count);
+        B  = _mm256_srl_epi32(B,  shift_count);
+
+        // Pack the pair of primaries for each half row into 32-bit lanes so
+        // the eight columns interleave with a shift and a bitwise or
+        if (rggb)
+        {
+            row1 = _mm256_or_si256(R,  _mm256_slli_epi32(G1, 16));
+            row2 = _mm256_or_si256(G2, _mm256_slli_epi32(B,  16));
+        }
+        else
+        {
+            row1 = _mm256_or_si256(G1, _mm256_slli_epi32(B,  16));
+            row2 = _mm256_or_si256(R,  _mm256_slli_epi32(G2, 16));
+        }
+
+        _mm256_storeu_si256((__m256i *)(output_row1_ptr + 2 * column), row1);
+        _mm256_storeu_si256((__m256i *)(output_row2_ptr + 2 * column), row2);
+    }
+
+    return vector_width;
+}
+
+#endif // VC5_HAVE_AVX2
+
+/*!
+	@brief Translation unit local body of @ref PackComponentsToRAW
 	
 	The inverse component transform for Bayer images (VC-5 Part 3)
 	is applied to the component arrays before combining the values
 	into a packed image.
+
+	The bit depth specific wrappers below inline this body with the
+	output bit depth as a compile time constant, so the shift that
+	positions the samples folds to an immediate in the inner loop.
  */
-CODEC_ERROR PackComponentsToRAW(const UNPACKED_IMAGE *image,
-                                PIXEL *output_buffer, size_t output_pitch,
-                                DIMENSION width, DIMENSION height,
-                                ENABLED_PARTS enabled_parts, uint16_t output_bit_depth, PIXEL_FORMAT output_format )
+STATIC_INLINE CODEC_ERROR PackComponentsToRAWImpl(const UNPACKED_IMAGE *image,
+                                                  PIXEL *output_buffer, size_t output_pitch,
+                                                  DIMENSION width, DIMENSION height,
+                                                  ENABLED_PARTS enabled_parts, uint16_t output_bit_depth, PIXEL_FORMAT output_format )
 {
     // Define pointers to the rows for each input component
     COMPONENT_VALUE *GS_input_buffer;
@@ -36,29 +130,50 @@ CODEC_ERROR PackComponentsToRAW(const UNPACKED_IMAGE *image,
     COMPONENT_VALUE *BG_input_buffer;
     COMPONENT_VALUE *GD_input_buffer;
     
-    // Define pointers to the rows for each output component
-    uint16_t *output_row1_ptr;
-    uint16_t *output_row2_ptr;
-    
     //size_t input_quarter_pitch;
     size_t output_half_pitch;
     
     int row;
-    
+
+    // The pixel format is loop invariant, so hoist the format switch out of
+    // the pixel loop as a flag (the vector path makes the same choice)
+    bool rggb = (output_format == PIXEL_FORMAT_RAW_RGGB_12 || output_format == PIXEL_FORMAT_RAW_RGGB_14);
+
+    assert(rggb || output_format == PIXEL_FORMAT_RAW_GBRG_12 || output_format == PIXEL_FORMAT_RAW_GBRG_14);
+    if (! (rggb || output_format == PIXEL_FORMAT_RAW_GBRG_12 || output_format == PIXEL_FORMAT_RAW_GBRG_14)) {
+        return CODEC_ERROR_UNSUPPORTED_FORMAT;
+    }
+
     GS_input_buffer = image->component_array_list[0].data;
     RG_input_buffer = image->component_array_list[1].data;
     BG_input_buffer = image->component_array_list[2].data;
     GD_input_buffer = image->component_array_list[3].data;
-    
+
+    // Read the component array pitches once so the row pointer computation
+    // does not reload them through the image structure every iteration
+    const size_t GS_pitch = image->component_array_list[0].pitch;
+    const size_t RG_pitch = image->component_array_list[1].pitch;
+    const size_t BG_pitch = image->component_array_list[2].pitch;
+    const size_t GD_pitch = image->component_array_list[3].pitch;
+
     // Compute the distance between the half rows in the Bayer grid
     output_half_pitch = output_pitch / 2;
     
+    // The rows are independent, so pack them in parallel: the pass reads
+    // the full resolution component arrays once and is bound by memory
+    // bandwidth, which multiple threads saturate better than one
+#if defined(GPR_USE_OPENMP)
+    #pragma omp parallel for schedule(static) if (height >= 32)
+#endif
     for (row = 0; row < height; row++)
     {
-        COMPONENT_VALUE *GS_input_row_ptr = (COMPONENT_VALUE *)((uintptr_t)GS_input_buffer + row * image->component_array_list[0].pitch);
-        COMPONENT_VALUE *RG_input_row_ptr = (COMPONENT_VALUE *)((uintptr_t)RG_input_buffer + row * image->component_array_list[1].pitch);
-        COMPONENT_VALUE *BG_input_row_ptr = (COMPONENT_VALUE *)((uintptr_t)BG_input_buffer + row * image->component_array_list[2].pitch);
-        COMPONENT_VALUE *GD_input_row_ptr = (COMPONENT_VALUE *)((uintptr_t)GD_input_buffer + row * image->component_array_list[3].pitch);
+        // The row pointers are computed from the row index (not advanced at
+        // the bottom of the loop) so the iterations stay independent for the
+        // parallel case
+        COMPONENT_VALUE *GS_input_row_ptr = (COMPONENT_VALUE *)((uintptr_t)GS_input_buffer + row * GS_pitch);
+        COMPONENT_VALUE *RG_input_row_ptr = (COMPONENT_VALUE *)((uintptr_t)RG_input_buffer + row * RG_pitch);
+        COMPONENT_VALUE *BG_input_row_ptr = (COMPONENT_VALUE *)((uintptr_t)BG_input_buffer + row * BG_pitch);
+        COMPONENT_VALUE *GD_input_row_ptr = (COMPONENT_VALUE *)((uintptr_t)GD_input_buffer + row * GD_pitch);
         
         uint8_t *output_row_ptr = (uint8_t *)output_buffer + row * output_pitch;
         
@@ -66,11 +181,23 @@ CODEC_ERROR PackComponentsToRAW(const UNPACKED_IMAGE *image,
         
         int column;
         
-        output_row1_ptr = (uint16_t *)output_row_ptr;
-        output_row2_ptr = (uint16_t *)(output_row_ptr + output_half_pitch);
+        // Define pointers to the rows for each output component
+        uint16_t *output_row1_ptr = (uint16_t *)output_row_ptr;
+        uint16_t *output_row2_ptr = (uint16_t *)(output_row_ptr + output_half_pitch);
         
+        column = 0;
+
+#if VC5_HAVE_AVX2
+        // Pack as much of the row as possible eight columns at a time
+        if (CpuHasAVX2())
+        {
+            column = PackBayerComponentsRow_AVX2(GS_input_row_ptr, RG_input_row_ptr, BG_input_row_ptr, GD_input_row_ptr,
+                                                 output_row1_ptr, output_row2_ptr, width, 16 - output_bit_depth, rggb);
+        }
+#endif
+
         // Pack the rows of Bayer components into the BYR4 pattern
-        for (column = 0; column < width; column++)
+        for (; column < width; column++)
         {
             int32_t GS, RG, BG, GD;
             int32_t R, G1, G2, B;
@@ -106,30 +233,54 @@ CODEC_ERROR PackComponentsToRAW(const UNPACKED_IMAGE *image,
             G1  >>= (16 - output_bit_depth);
             G2  >>= (16 - output_bit_depth);
             
-            switch (output_format)
+            if (rggb)
+            {
+                output_row1_ptr[2 * column + 0] = (uint16_t)R;
+                output_row1_ptr[2 * column + 1] = (uint16_t)G1;
+                output_row2_ptr[2 * column + 0] = (uint16_t)G2;
+                output_row2_ptr[2 * column + 1] = (uint16_t)B;
+            }
+            else
             {
-                case PIXEL_FORMAT_RAW_RGGB_12:
-                case PIXEL_FORMAT_RAW_RGGB_14:
-                    output_row1_ptr[2 * column + 0] = (uint16_t)R;
-                    output_row1_ptr[2 * column + 1] = (uint16_t)G1;
-                    output_row2_ptr[2 * column + 0] = (uint16_t)G2;
-                    output_row2_ptr[2 * column + 1] = (uint16_t)B;
-                    break;
-                    
-                case PIXEL_FORMAT_RAW_GBRG_12:
-                case PIXEL_FORMAT_RAW_GBRG_14:
-                    output_row1_ptr[2 * column + 0] = (uint16_t)G1;
-                    output_row1_ptr[2 * column + 1] = (uint16_t)B;
-                    output_row2_ptr[2 * column + 0] = (uint16_t)R;
-                    output_row2_ptr[2 * column + 1] = (uint16_t)G2;
-                    break;
-                    
-                default:
-                    assert(0);
-                    break;
+                output_row1_ptr[2 * column + 0] = (uint16_t)G1;
+                output_row1_ptr[2 * column + 1] = (uint16_t)B;
+                output_row2_ptr[2 * column + 0] = (uint16_t)R;
+                output_row2_ptr[2 * column + 1] = (uint16_t)G2;
             }
         }
     }
     
     return CODEC_ERROR_OKAY;
 }
+
+CODEC_ERROR PackComponentsToRAW_12(const UNPACKED_IMAGE *image,
+                                   PIXEL *output_buffer, size_t output_pitch,
+                                   DIMENSION width, DIMENSION height,
+                                   ENABLED_PARTS enabled_parts, PIXEL_FORMAT output_format )
+{
+    return PackComponentsToRAWImpl(image, output_buffer, output_pitch, width, height, enabled_parts, 12, output_format);
+}
+
+CODEC_ERROR PackComponentsToRAW_14(const UNPACKED_IMAGE *image,
+                                   PIXEL *output_buffer, size_t output_pitch,
+                                   DIMENSION width, DIMENSION height,
+                                   ENABLED_PARTS enabled_parts, PIXEL_FORMAT output_format )
+{
+    return PackComponentsToRAWImpl(image, output_buffer, output_pitch, width, height, enabled_parts, 14, output_format);
+}
+
+CODEC_ERROR PackComponentsToRAW_16(const UNPACKED_IMAGE *image,
+                                   PIXEL *output_buffer, size_t output_pitch,
+                                   DIMENSION width, DIMENSION height,
+                                   ENABLED_PARTS enabled_parts, PIXEL_FORMAT output_format )
+{
+    return PackComponentsToRAWImpl(image, output_buffer, output_pitch, width, height, enabled_parts, 16, output_format);
+}
+
+CODEC_ERROR PackComponentsToRAW(const UNPACKED_IMAGE *image,
+                                PIXEL *output_buffer, size_t output_pitch,
+                                DIMENSION width, DIMENSION height,
+                                ENABLED_PARTS enabled_parts, uint16_t output_bit_depth, PIXEL_FORMAT output_format )
+{
+    return PackComponentsToRAWImpl(image, output_buffer, output_pitch, width, height, enabled_parts, output_bit_depth, output_format);
+}
@@ -27,6 +27,22 @@ extern "C" {
                                     PIXEL *output_buffer, size_t output_pitch,
                                     DIMENSION width, DIMENSION height,
                                     ENABLED_PARTS enabled_parts, uint16_t output_bit_depth, PIXEL_FORMAT output_format );
+
+    //! Bit depth specializations that fold the output shift to a constant
+    CODEC_ERROR PackComponentsToRAW_12(const UNPACKED_IMAGE *image,
+                                       PIXEL *output_buffer, size_t output_pitch,
+                                       DIMENSION width, DIMENSION height,
+                                       ENABLED_PARTS enabled_parts, PIXEL_FORMAT output_format );
+
+    CODEC_ERROR PackComponentsToRAW_14(const UNPACKED_IMAGE *image,
+                                       PIXEL *output_buffer, size_t output_pitch,
+                                       DIMENSION width, DIMENSION height,
+                                       ENABLED_PARTS enabled_parts, PIXEL_FORMAT output_format );
+
+    CODEC_ERROR PackComponentsToRAW_16(const UNPACKED_IMAGE *image,
+                                       PIXEL *output_buffer, size_t output_pitch,
+                                       DIMENSION width, DIMENSION height,
+                                       ENABLED_PARTS enabled_parts, PIXEL_FORMAT output_format );
     
 #ifdef __cplusplus
 }
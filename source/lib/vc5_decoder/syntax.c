@@ -18,35 +18,6 @@
 
 #include "headers.h"
 
-//! Size of a tag or value (in bits)
-#define BITSTREAM_TAG_SIZE				16
-
-/*!
-	@brief Read the next tag-valie pair from the bitstream.
-
-	The next tag is read from the bitstream and the next value that
-	immediately follows the tag in the bitstreeam are read from the
-	bitstream.
-
-	The value may be the length of the payload in bytes or the value
-	may be a single scalar.  This routine only reads the next tag and
-	value and does not intepret the tag or value and does not read any
-	data that may follow the segment in the bitstream.
-
-	The tag and value are interpreted by @ref UpdateCodecState and that
-	routine may read additional information from the bitstream.
-
-	If the value is the length of the payload then it encodes the number
-	of bytes in the segment payload, not counting the segment header.
-*/
-TAGVALUE GetSegment(BITSTREAM *stream)
-{
-	TAGVALUE segment;
-	segment.tuple.tag = (TAGWORD)GetBits(stream, 16);
-	segment.tuple.value = (TAGWORD)GetBits(stream, 16);
-	return segment;
-}
-
 /*!
 	@brief Read the specified tag from the bitstream and return the value
 */
@@ -54,63 +25,18 @@ TAGWORD GetValue(BITSTREAM *stream, int tag)
 {
 	TAGVALUE segment = GetTagValue(stream);
 
-	assert(stream->error == BITSTREAM_ERROR_OKAY);
+	// A single test covers both failure cases so the common path is one
+	// predictable branch (a stream error cannot produce a matching tag)
+	if (IsValidSegment(stream, segment, tag)) {
+		return segment.tuple.value;
+	}
+
+	assert(0);
 	if (stream->error == BITSTREAM_ERROR_OKAY) {
-		assert(segment.tuple.tag == tag);
-		if (segment.tuple.tag == tag) {
-			return segment.tuple.value;
-		}
-		else {
-			stream->error = BITSTREAM_ERROR_BADTAG;
-		}
+		stream->error = BITSTREAM_ERROR_BADTAG;
 	}
 
 	// An error has occurred so return zero (error code was set above)
 	return 0;
 }
 
-/*!
-	@brief Read the next tag value pair from the bitstream
-*/
-TAGVALUE GetTagValue(BITSTREAM *stream)
-{
-	TAGVALUE segment = GetSegment(stream);
-	while (segment.tuple.tag < 0) {
-		segment = GetSegment(stream);
-	}
-
-	return segment;
-}
-
-/*!
-	@brief Return true if the tag is optional
-*/
-bool IsTagOptional(TAGWORD tag)
-{
-	return (tag < 0);
-}
-
-/*!
-	@brief Return true if the tag is required
-*/
-bool IsTagRequired(TAGWORD tag)
-{
-	return (tag >= 0);
-}
-
-/*!
-	@brief Return true if a valid tag read from the bitstream
-*/
-bool IsValidSegment(BITSTREAM *stream, TAGVALUE segment, TAGWORD tag)
-{
-	return (stream->error == BITSTREAM_ERROR_OKAY &&
-			segment.tuple.tag == tag);
-}
-
-/*!
-	@brief Return true if the tag value pair has the specified tag and value
-*/
-bool IsTagValue(TAGVALUE segment, int tag, TAGWORD value)
-{
-	return (segment.tuple.tag == tag && segment.tuple.value == value);
-}
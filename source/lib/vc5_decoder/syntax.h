@@ -19,23 +19,88 @@
 #ifndef DECODER_SYNTAX_H
 #define DECODER_SYNTAX_H
 
-#ifdef __cplusplus
-extern "C" {
-#endif
+/*!
+	@brief Read the next tag-value pair from the bitstream.
 
-    TAGVALUE GetSegment(BITSTREAM *stream);
+	The next tag is read from the bitstream and the next value that
+	immediately follows the tag in the bitstreeam are read from the
+	bitstream.
 
-    TAGWORD GetValue(BITSTREAM *stream, int tag);
+	The value may be the length of the payload in bytes or the value
+	may be a single scalar.  This routine only reads the next tag and
+	value and does not intepret the tag or value and does not read any
+	data that may follow the segment in the bitstream.
+
+	The tag and value are interpreted by @ref UpdateCodecState and that
+	routine may read additional information from the bitstream.
 
-    TAGVALUE GetTagValue(BITSTREAM *stream);
+	If the value is the length of the payload then it encodes the number
+	of bytes in the segment payload, not counting the segment header.
 
-    bool IsTagOptional(TAGWORD tag);
+	The routine is defined in the header so the per segment parsing
+	loops call straight into the bitstream without a call frame.
+*/
+STATIC_INLINE TAGVALUE GetSegment(BITSTREAM *stream)
+{
+	TAGVALUE segment;
+	segment.tuple.tag = (TAGWORD)GetBits(stream, 16);
+	segment.tuple.value = (TAGWORD)GetBits(stream, 16);
+	return segment;
+}
 
-    bool IsTagRequired(TAGWORD tag);
+/*!
+	@brief Read the next required tag value pair from the bitstream
 
-    bool IsValidSegment(BITSTREAM *stream, TAGVALUE segment, TAGWORD tag);
+	Optional tags (negative tag values) are skipped.
+*/
+STATIC_INLINE TAGVALUE GetTagValue(BITSTREAM *stream)
+{
+	TAGVALUE segment = GetSegment(stream);
+	while (segment.tuple.tag < 0) {
+		segment = GetSegment(stream);
+	}
 
-    bool IsTagValue(TAGVALUE segment, int tag, TAGWORD value);
+	return segment;
+}
+
+/*!
+	@brief Return true if the tag is optional
+*/
+STATIC_INLINE bool IsTagOptional(TAGWORD tag)
+{
+	return (tag < 0);
+}
+
+/*!
+	@brief Return true if the tag is required
+*/
+STATIC_INLINE bool IsTagRequired(TAGWORD tag)
+{
+	return (tag >= 0);
+}
+
+/*!
+	@brief Return true if a valid tag read from the bitstream
+*/
+STATIC_INLINE bool IsValidSegment(BITSTREAM *stream, TAGVALUE segment, TAGWORD tag)
+{
+	return (stream->error == BITSTREAM_ERROR_OKAY &&
+			segment.tuple.tag == tag);
+}
+
+/*!
+	@brief Return true if the tag value pair has the specified tag and value
+*/
+STATIC_INLINE bool IsTagValue(TAGVALUE segment, int tag, TAGWORD value)
+{
+	return (segment.tuple.tag == tag && segment.tuple.value == value);
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    TAGWORD GetValue(BITSTREAM *stream, int tag);
 
 #ifdef __cplusplus
 }
@@ -18,6 +18,98 @@
 
 #include "headers.h"
 
+//! Fast codebook lookup table (the baseline codec uses a single static
+//! codebook, so one table instance is built on first use and reused)
+static VLC_FAST_ENTRY fast_codebook_table[1 << VLC_FAST_BITS];
+static const CODEBOOK *fast_codebook = NULL;
+
+/*!
+	@brief Return the fast lookup table for the specified codebook
+
+	The table maps every possible value of the next @ref VLC_FAST_BITS
+	bits in the bitstream to the decoded run and the number of bits
+	consumed, so the frequent short codewords are resolved with one load
+	instead of a bit serial walk of the codebook.  Each codeword that
+	fits the index, together with its sign suffix for non-zero
+	magnitudes, fills the block of entries sharing its prefix; the codes
+	are prefix free so the blocks cannot overlap.  The table is built on
+	the first call (the codec performs all setup on a single thread) and
+	rebuilt only if a different codebook is presented.
+*/
+const VLC_FAST_ENTRY *GetFastCodebookTable(const CODEBOOK *codebook)
+{
+	if (fast_codebook != codebook)
+	{
+		const RLV *codebook_entry = (const RLV *)((const uint8_t *)codebook + sizeof(CODEBOOK));
+		int codebook_length = codebook->length;
+		int entry_index;
+
+		memset(fast_codebook_table, 0, sizeof(fast_codebook_table));
+
+		for (entry_index = 0; entry_index < codebook_length; entry_index++)
+		{
+			const RLV *entry = &codebook_entry[entry_index];
+			uint32_t size = entry->size;
+			uint32_t prefix;
+			uint32_t suffix_count;
+			uint32_t suffix;
+
+			// Special markers are decoded against the codebook
+			if (entry->count == 0) {
+				continue;
+			}
+
+			if (entry->value == 0)
+			{
+				// A run of zeros has no sign suffix
+				if (size > VLC_FAST_BITS) {
+					continue;
+				}
+
+				prefix = entry->bits << (VLC_FAST_BITS - size);
+				suffix_count = (uint32_t)1 << (VLC_FAST_BITS - size);
+
+				for (suffix = 0; suffix < suffix_count; suffix++)
+				{
+					fast_codebook_table[prefix + suffix].value = 0;
+					fast_codebook_table[prefix + suffix].count = (uint16_t)entry->count;
+					fast_codebook_table[prefix + suffix].size = (uint8_t)size;
+				}
+			}
+			else
+			{
+				// Fold the sign suffix into the table entries
+				if (size + VLC_SIGNCODE_SIZE > VLC_FAST_BITS) {
+					continue;
+				}
+
+				prefix = ((entry->bits << 1) | VLC_POSITIVE_CODE) << (VLC_FAST_BITS - size - 1);
+				suffix_count = (uint32_t)1 << (VLC_FAST_BITS - size - 1);
+
+				for (suffix = 0; suffix < suffix_count; suffix++)
+				{
+					fast_codebook_table[prefix + suffix].value = (int16_t)entry->value;
+					fast_codebook_table[prefix + suffix].count = (uint16_t)entry->count;
+					fast_codebook_table[prefix + suffix].size = (uint8_t)(size + VLC_SIGNCODE_SIZE);
+				}
+
+				prefix = ((entry->bits << 1) | VLC_NEGATIVE_CODE) << (VLC_FAST_BITS - size - 1);
+
+				for (suffix = 0; suffix < suffix_count; suffix++)
+				{
+					fast_codebook_table[prefix + suffix].value = (int16_t)neg(entry->value);
+					fast_codebook_table[prefix + suffix].count = (uint16_t)entry->count;
+					fast_codebook_table[prefix + suffix].size = (uint8_t)(size + VLC_SIGNCODE_SIZE);
+				}
+			}
+		}
+
+		fast_codebook = codebook;
+	}
+
+	return fast_codebook_table;
+}
+
 /*!
 	@brief Parse a run length coded magnitude in the bitstream
 */
@@ -91,6 +183,7 @@ CODEC_ERROR GetRun(BITSTREAM *stream, CODEBOOK *codebook, RUN *run)
 	if (value != 0)
 	{
 		BITWORD sign;
+		int32_t sign_mask;
 
 		// Something is wrong if the value is already negative
 		assert(value > 0);
@@ -98,8 +191,10 @@ CODEC_ERROR GetRun(BITSTREAM *stream, CODEBOOK *codebook, RUN *run)
 		// Get the codeword for the sign of the value
 		sign = GetBits(stream, VLC_SIGNCODE_SIZE);
 
-		// Change the sign if the codeword signalled a negative value
-		value = ((sign == VLC_NEGATIVE_CODE) ? neg(value) : value);
+		// Negate the value with arithmetic instead of a branch (the sign
+		// mask is all ones when the codeword signalled a negative value)
+		sign_mask = -(int32_t)(sign == VLC_NEGATIVE_CODE);
+		value = (value ^ sign_mask) - sign_mask;
 	}
 
 	// Return the signed value of the coefficient
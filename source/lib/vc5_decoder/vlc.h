@@ -33,14 +33,20 @@
 	but all codec implementations only use runs of zeros.  The
 	codeword for a non-zero value is followed by the sign bit.
 
+	The fields are sized to the actual ranges in the codebook (the
+	longest codeword is 26 bits, the longest run is 320 and the largest
+	magnitude is 255) so each entry occupies 12 bytes instead of 16 and
+	the whole table stays resident in fewer cache lines during the
+	fallback codebook walk.
+
 	@todo Could add the sign bit to the magnitude entries in this
 	table if it improves performance or makes the code more clear.
 */
 typedef struct _rlv {
-	uint_fast8_t size;		//!< Size of code word in bits
+	uint8_t size;			//!< Size of code word in bits
 	uint32_t bits;			//!< Code word bits right justified
-	uint32_t count;			//!< Run length
-	int32_t value;			//!< Run value (unsigned)
+	uint16_t count;			//!< Run length
+	int16_t value;			//!< Run value (unsigned)
 } RLV;
 
 /*!
@@ -89,12 +95,32 @@ typedef struct _run {
 //! Initializer for the run length data structure
 #define RUN_INITIALIZER		{0, 0}
 
+//! Number of leading bits used to index the fast codebook lookup table
+#define VLC_FAST_BITS		12
+
+/*!
+	@brief Entry in the fast codebook lookup table
+
+	The table is indexed by the next @ref VLC_FAST_BITS bits in the
+	bitstream and resolves the most frequent codewords in one load.  For
+	non-zero magnitudes the sign suffix is folded into the entry, so the
+	value is signed and the size includes the sign bit.  A size of zero
+	marks a codeword that is longer than the table index (including the
+	special markers) and must be decoded against the codebook.
+*/
+typedef struct _vlc_fast_entry {
+	int16_t value;			//!< Signed run value
+	uint16_t count;			//!< Run length
+	uint8_t size;			//!< Total bits consumed (zero for fallback)
+} VLC_FAST_ENTRY;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
     CODEC_ERROR GetRlv(BITSTREAM *stream, CODEBOOK *codebook, RUN *run);
     CODEC_ERROR GetRun(BITSTREAM *stream, CODEBOOK *codebook, RUN *run);
+    const VLC_FAST_ENTRY *GetFastCodebookTable(const CODEBOOK *codebook);
 
 #ifdef __cplusplus
 }
@@ -21,27 +21,24 @@
 #include "headers.h"
 
 /*!
-	@brief Apply the inverse wavelet transform to reconstruct a lowpass band
-
-	This routine reconstructs the lowpass band in the output wavelet from the
-	decoded bands in the input wavelet.  The prescale argument is used to undo
-	scaling that may have been performed during encoding to prevent overflow.
-	
-	@todo Replace the two different routines for different prescale shifts with
-	a single routine that can handle any prescale shift.
+	@brief Shared body of the two inverse spatial transform dispatchers
+
+	The two public routines below differ only in how the output buffer
+	and its dimensions are sourced (another wavelet versus a component
+	array), so the argument checks and the prescale dispatch live here
+	and each wrapper is a thin shim.  The prescale argument selects the
+	transform variant: the descale transform undoes the scaling that
+	was applied during encoding to prevent overflow.
 */
-CODEC_ERROR TransformInverseSpatialQuantLowpass(gpr_allocator *allocator, WAVELET *input, WAVELET *output, uint16_t prescale)
+STATIC_INLINE CODEC_ERROR InverseSpatialQuantCommon(gpr_allocator *allocator, WAVELET *input,
+													PIXEL *output_buffer, int output_pitch,
+													DIMENSION output_width, DIMENSION output_height,
+													uint16_t prescale)
 {
 	// Dimensions of each wavelet band
 	DIMENSION input_width = input->width;
 	DIMENSION input_height = input->height;
 
-	// The output width may be less than twice the input width if the output width is odd
-	DIMENSION output_width = output->width;
-
-	// The output height may be less than twice the input height if the output height is odd
-	DIMENSION output_height = output->height;
-
 	// Check that a valid input image has been provided
 	assert(input != NULL);
 	assert(input->data[0] != NULL);
@@ -49,8 +46,8 @@ CODEC_ERROR TransformInverseSpatialQuantLowpass(gpr_allocator *allocator, WAVELE
 	assert(input->data[2] != NULL);
 	assert(input->data[3] != NULL);
 
-	// Check that the output image is a gray image or a lowpass wavelet band
-	assert(output->data[0] != NULL);
+	// Check that a valid output buffer has been provided
+	assert(output_width > 0 && output_height > 0 && output_pitch > 0 && output_buffer != NULL);
 
 	// Check for valid quantization values
 	if (input->quant[0] == 0) {
@@ -67,13 +64,13 @@ CODEC_ERROR TransformInverseSpatialQuantLowpass(gpr_allocator *allocator, WAVELE
 		// This is a spatial transform for the lowpass temporal band
 		assert(prescale == 2);
 
-		// Apply the inverse spatial transform for a lowpass band that is not prescaled
+		// Apply the inverse spatial transform for a lowpass band that was prescaled
 		InvertSpatialQuantDescale16s(allocator,
 									 (PIXEL *)input->data[0], input->pitch,
 									 (PIXEL *)input->data[1], input->pitch,
 									 (PIXEL *)input->data[2], input->pitch,
 									 (PIXEL *)input->data[3], input->pitch,
-									 output->data[0], output->pitch,
+									 output_buffer, output_pitch,
 									 input_width, input_height,
 									 output_width, output_height,
 									 prescale, input->quant);
@@ -89,7 +86,7 @@ CODEC_ERROR TransformInverseSpatialQuantLowpass(gpr_allocator *allocator, WAVELE
 							  (PIXEL *)input->data[1], input->pitch,
 							  (PIXEL *)input->data[2], input->pitch,
 							  (PIXEL *)input->data[3], input->pitch,
-							  output->data[0], output->pitch,
+							  output_buffer, output_pitch,
 							  input_width, input_height,
 							  output_width, output_height,
 							  input->quant);
@@ -98,6 +95,25 @@ CODEC_ERROR TransformInverseSpatialQuantLowpass(gpr_allocator *allocator, WAVELE
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Apply the inverse wavelet transform to reconstruct a lowpass band
+
+	This routine reconstructs the lowpass band in the output wavelet from the
+	decoded bands in the input wavelet.  The prescale argument is used to undo
+	scaling that may have been performed during encoding to prevent overflow.
+*/
+CODEC_ERROR TransformInverseSpatialQuantLowpass(gpr_allocator *allocator, WAVELET *input, WAVELET *output, uint16_t prescale)
+{
+	// Check that the output image is a gray image or a lowpass wavelet band
+	assert(output->data[0] != NULL);
+
+	// The output dimensions may be less than twice the input dimensions if odd
+	return InverseSpatialQuantCommon(allocator, input,
+									 output->data[0], output->pitch,
+									 output->width, output->height,
+									 prescale);
+}
+
 /*!
 	@brief Apply the inverse wavelet transform to reconstruct a component array
 
@@ -113,61 +129,8 @@ CODEC_ERROR TransformInverseSpatialQuantArray(gpr_allocator *allocator,
 											  size_t output_pitch,
 											  PRESCALE prescale)
 {
-	// Dimensions of each wavelet band
-	DIMENSION input_width = input->width;
-	DIMENSION input_height = input->height;
-
-	// Check that a valid input image has been provided
-	assert(input != NULL);
-	assert(input->data[0] != NULL);
-	assert(input->data[1] != NULL);
-	assert(input->data[2] != NULL);
-	assert(input->data[3] != NULL);
-
-	// Check for valid quantization values
-	if (input->quant[0] == 0) {
-		input->quant[0] = 1;
-	}
-
-	assert(input->quant[0] > 0);
-	assert(input->quant[1] > 0);
-	assert(input->quant[2] > 0);
-	assert(input->quant[3] > 0);
-
-	assert(output_width > 0 && output_height > 0 && output_pitch > 0 && output_buffer != NULL);
-
-	if (prescale > 1)
-	{
-		// This is a spatial transform for the lowpass temporal band
-		assert(prescale == 2);
-
-		// Apply the inverse spatial transform for a lowpass band that is not prescaled
-		InvertSpatialQuantDescale16s(allocator,
-									 (PIXEL *)input->data[0], input->pitch,
-									 (PIXEL *)input->data[1], input->pitch,
-									 (PIXEL *)input->data[2], input->pitch,
-									 (PIXEL *)input->data[3], input->pitch,
+	return InverseSpatialQuantCommon(allocator, input,
 									 (PIXEL *)output_buffer, (int)output_pitch,
-									 input_width, input_height,
 									 output_width, output_height,
-									 prescale, input->quant);
-	}
-	else
-	{
-		// This case does not handle any prescaling applied during encoding
-		assert(prescale == 0);
-
-		// Apply the inverse spatial transform for a lowpass band that is not prescaled
-		InvertSpatialQuant16s(allocator,
-							  (PIXEL *)input->data[0], input->pitch,
-							  (PIXEL *)input->data[1], input->pitch,
-							  (PIXEL *)input->data[2], input->pitch,
-							  (PIXEL *)input->data[3], input->pitch,
-							  (PIXEL *)output_buffer, (int)output_pitch,
-							  input_width, input_height,
-							  output_width, output_height,
-							  input->quant);
-	}
-
-	return CODEC_ERROR_OKAY;
+									 prescale);
 }
@@ -199,39 +199,30 @@ CODEC_ERROR ComputeRunLengthCodeTable(const gpr_allocator *allocator,
 
 /*!
 	@brief Sort the codebook into decreasing length of the run
+
+	An insertion sort is used since the codebook may already be sorted,
+	in which case each entry is compared with its predecessor once and
+	nothing is moved.
 */
 CODEC_ERROR SortDecreasingRunLength(RLC *codebook, int length)
 {
 	int i;
 	int j;
 
-	// Perform a simple bubble sort since the codebook may already be sorted
-	for (i = 0; i < length; i++)
+	for (i = 1; i < length; i++)
 	{
-		for (j = i+1; j < length; j++)
-		{
-			// Should not have more than one codebook entry with the same run length
-			assert(codebook[i].count != codebook[j].count);
-
-			// Exchange codebook entries if the current entry is smaller
-			if (codebook[i].count < codebook[j].count)
-			{
-				int size = codebook[i].size;
-				uint32_t  bits = codebook[i].bits;
-				int count = codebook[i].count;
-
-				codebook[i].size = codebook[j].size;
-				codebook[i].bits = codebook[j].bits;
-				codebook[i].count = codebook[j].count;
+		RLC entry = codebook[i];
 
-				codebook[j].size = size;
-				codebook[j].bits = bits;
-				codebook[j].count = count;
-			}
+		// Shift entries with shorter runs right until the slot is found
+		for (j = i; j > 0 && codebook[j-1].count < entry.count; j--)
+		{
+			codebook[j] = codebook[j-1];
 		}
 
-		// After two iterations that last two items should be in the proper order
-		assert(i == 0 || codebook[i-1].count > codebook[i].count);
+		// Should not have more than one codebook entry with the same run length
+		assert(j == 0 || codebook[j-1].count > entry.count);
+
+		codebook[j] = entry;
 	}
 
 	return CODEC_ERROR_OKAY;
@@ -347,8 +338,13 @@ CODEC_ERROR FillMagnitudeEncodingTable(const CODEBOOK *codebook, VLE *mags_table
 
 	uint32_t codebook_index;
 
-	int16_t cubic_table[1025];
-	int cubic_table_length = sizeof(cubic_table) / sizeof(cubic_table[0]);
+	// Companded magnitude for each table index (whichever companding
+	// curve the flags select is tabulated once before the fill loop)
+	int16_t companding_table[1025];
+	int companding_table_length = sizeof(companding_table) / sizeof(companding_table[0]);
+
+	// Codeword for each coefficient magnitude, indexed by the magnitude
+	VLE magnitude_codes[1025];
 
 	int mags_table_index;
 
@@ -365,60 +361,52 @@ CODEC_ERROR FillMagnitudeEncodingTable(const CODEBOOK *codebook, VLE *mags_table
 		}
 	}
 	assert(maximum_magnitude_value > 0);
+	assert(maximum_magnitude_value < (int32_t)(sizeof(magnitude_codes) / sizeof(magnitude_codes[0])));
 
-	if (flags & CODESET_FLAGS_COMPANDING_CUBIC)
-	{
-		ComputeCubicTable(cubic_table, cubic_table_length, maximum_magnitude_value);
-	}
+	// Index the magnitude codewords by magnitude with one pass over the
+	// codebook so the fill loop below does not search the codebook for
+	// every table entry
+	memset(magnitude_codes, 0, (maximum_magnitude_value + 1) * sizeof(magnitude_codes[0]));
 
-	// Fill each table entry with the codeword for that (signed) value
-	for (mags_table_index = 0; mags_table_index < mags_table_length; mags_table_index++)
+	for (codebook_index = 0; codebook_index < codebook->length; codebook_index++)
 	{
-		// Compute the magnitude that corresponds to this index
-		int32_t magnitude = mags_table_index;
-		uint32_t codeword;
-		int codesize;
-
-		// Apply the companding curve
-		if (flags & CODESET_FLAGS_COMPANDING_CUBIC)
+		if (codebook_entry[codebook_index].count == 1)
 		{
-			// Apply a cubic companding curve
-			assert(magnitude < cubic_table_length);
-			magnitude = cubic_table[magnitude];
+			int32_t codebook_value = codebook_entry[codebook_index].value;
+			magnitude_codes[codebook_value].bits = codebook_entry[codebook_index].bits;
+			magnitude_codes[codebook_value].size = codebook_entry[codebook_index].size;
 		}
-		else if (flags & CODESET_FLAGS_COMPANDING_NONE)
-		{
+	}
+
+	// Tabulate the companding curve selected by the flags so the fill
+	// loop below does not retest the loop invariant flags per entry
+	assert(mags_table_length <= companding_table_length);
+	if (flags & CODESET_FLAGS_COMPANDING_CUBIC)
+	{
+		// Apply a cubic companding curve
+		ComputeCubicTable(companding_table, companding_table_length, maximum_magnitude_value);
+	}
+	else for (mags_table_index = 0; mags_table_index < mags_table_length; mags_table_index++)
+	{
+		companding_table[mags_table_index] = (flags & CODESET_FLAGS_COMPANDING_NONE) ?
 			// Do not apply a companding curve
-		}
-		else
-		{
+			(int16_t)mags_table_index :
 			// Apply an old-style companding curve
-			magnitude = CompandedValue(magnitude);
-		}
-
-		// Is the magnitude larger than the number of entries in the codebook?
-		if (magnitude > maximum_magnitude_value) {
-			magnitude = maximum_magnitude_value;
-		}
-
-		// Find the codebook entry corresponding to this coefficient magnitude
-        codeword = 0;
-		codesize = 0;
-		for (codebook_index = 0; codebook_index < codebook->length; codebook_index++)
-		{
-			if (codebook_entry[codebook_index].value == magnitude)
-			{
-				assert(codebook_entry[codebook_index].count == 1);
-				codeword = codebook_entry[codebook_index].bits;
-				codesize = codebook_entry[codebook_index].size;
-				break;
-			}
-		}
-		assert(0 < codesize && codesize <= 32);
-
-		mags_table_entry[mags_table_index].bits = codeword;
-		mags_table_entry[mags_table_index].size = codesize;
+			(int16_t)CompandedValue(mags_table_index);
+	}
 
+	// Fill each table entry with the codeword for that (signed) value
+	for (mags_table_index = 0; mags_table_index < mags_table_length; mags_table_index++)
+	{
+		// Compute the companded magnitude that corresponds to this index,
+		// clamped to the largest magnitude in the codebook (a conditional
+		// expression so the clamp compiles without a branch)
+		int32_t magnitude = minimum(companding_table[mags_table_index], maximum_magnitude_value);
+
+		// Copy the codeword for this coefficient magnitude as one store
+		// (the entry carries both the codeword bits and the size)
+		assert(0 < magnitude_codes[magnitude].size && magnitude_codes[magnitude].size <= 32);
+		mags_table_entry[mags_table_index] = magnitude_codes[magnitude];
 	}
 
 	return CODEC_ERROR_OKAY;
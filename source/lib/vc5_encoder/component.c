@@ -58,25 +58,24 @@ CODEC_ERROR AllocateComponentTransform(gpr_allocator *allocator, COMPONENT_TRANS
     size_t transform_matrix_size = component_count * component_count * sizeof(uint16_t);
     size_t transform_offset_size = component_count * sizeof(uint16_t);
     size_t transform_scale_size = component_count * sizeof(uint16_t);
-    
-    transform->transform_matrix = (uint16_t *)allocator->Alloc(transform_matrix_size);
-    transform->transform_offset = (uint16_t *)allocator->Alloc(transform_offset_size);
-    transform->transform_scale = (uint16_t *)allocator->Alloc(transform_scale_size);
 
-    if (transform->transform_matrix == NULL ||
-        transform->transform_offset == NULL ||
-        transform->transform_scale == NULL) {
-        
-        //TODO: Should clean up the partially allocated transform arrays
+    // The three arrays are used together, so carve them from a single
+    // allocation (the matrix is first so the release routine can free
+    // the whole block through the matrix pointer)
+    uint16_t *base = (uint16_t *)allocator->Alloc(transform_matrix_size + transform_offset_size + transform_scale_size);
+
+    if (base == NULL) {
         return CODEC_ERROR_OUTOFMEMORY;
     }
 
+    transform->transform_matrix = base;
+    transform->transform_offset = base + (component_count * component_count);
+    transform->transform_scale = transform->transform_offset + component_count;
+
     transform->component_count = component_count;
 
-    memset(transform->transform_matrix, 0, transform_matrix_size);
-    memset(transform->transform_offset, 0, transform_offset_size);
-    memset(transform->transform_scale, 0, transform_scale_size);
-    
+    memset(base, 0, transform_matrix_size + transform_offset_size + transform_scale_size);
+
     return CODEC_ERROR_OKAY;
 }
 
@@ -108,9 +107,9 @@ CODEC_ERROR ReleaseComponentTransform(gpr_allocator *allocator, COMPONENT_TRANSF
 {
     if (transform != NULL)
     {
+        // The matrix pointer is the base of the single allocation that
+        // holds all three arrays (see @ref AllocateComponentTransform)
         allocator->Free(transform->transform_matrix);
-        allocator->Free(transform->transform_offset);
-        allocator->Free(transform->transform_scale);
         memset(transform, 0, sizeof(COMPONENT_TRANSFORM));
     }
     return CODEC_ERROR_OKAY;
@@ -264,10 +263,10 @@ bool IsComponentTransformIdentity(COMPONENT_TRANSFORM *transform)
         }
         
         // Is the transform offset zero?
-        if (transform->transform_offset != 0) return false;
-        
+        if (transform->transform_offset[component_row] != 0) return false;
+
         // Is the scale factor zero?
-        if (transform->transform_scale != 0) return false;
+        if (transform->transform_scale[component_row] != 0) return false;
     }
 
     // The component transform is the identity transform
@@ -311,7 +310,7 @@ CODEC_ERROR WriteComponentTransform(COMPONENT_TRANSFORM *transform, BITSTREAM *s
     {
         const int component_count = transform->component_count;
         const size_t chunk_payload_size = (component_count * component_count + 2 * component_count) * sizeof(uint8_t);
-        const size_t chunk_payload_padding = sizeof(SEGMENT) - (chunk_payload_size % sizeof(SEGMENT));
+        const size_t chunk_payload_padding = (sizeof(SEGMENT) - (chunk_payload_size % sizeof(SEGMENT))) % sizeof(SEGMENT);
         const int chunk_payload_length = (int)((chunk_payload_size + sizeof(SEGMENT) - 1) / sizeof(SEGMENT));
         int i;
         
@@ -346,20 +345,18 @@ CODEC_ERROR WriteComponentTransform(COMPONENT_TRANSFORM *transform, BITSTREAM *s
             PutBits(stream, scale_value, 8);
         }
         
-        // Pad the remainer of the chunk payload with zeros
-        for (i = 0; i < (int)chunk_payload_padding; i++) {
-            PutBits(stream, 0, 8);
-        }
-        
+        // Pad the remainder of the chunk payload with zeros in one call
+        PutBits(stream, 0, (BITCOUNT)(chunk_payload_padding * 8));
+
         // Check that the bitstream is aligned on a segment boundary
         assert(IsAlignedSegment(stream));
         if (! (IsAlignedSegment(stream))) {
             return CODEC_ERROR_UNEXPECTED;
         }
-        
+
         return CODEC_ERROR_OKAY;
     }
-    
+
     return CODEC_ERROR_UNEXPECTED;
 }
 
@@ -372,7 +369,7 @@ CODEC_ERROR WriteComponentPermutation(COMPONENT_PERMUTATION *permutation, BITSTR
     {
         const int component_count = permutation->component_count;
         const size_t chunk_payload_size = component_count * sizeof(uint8_t);
-        const size_t chunk_payload_padding = sizeof(SEGMENT) - (chunk_payload_size % sizeof(SEGMENT));
+        const size_t chunk_payload_padding = (sizeof(SEGMENT) - (chunk_payload_size % sizeof(SEGMENT))) % sizeof(SEGMENT);
         const int chunk_payload_length = (int)((chunk_payload_size + sizeof(SEGMENT) - 1) / sizeof(SEGMENT));
         int i;
         
@@ -385,11 +382,10 @@ CODEC_ERROR WriteComponentPermutation(COMPONENT_PERMUTATION *permutation, BITSTR
             PutBits(stream, value, 8);
         }
         
-        // Pad the remainer of the chunk payload with zeros
-        for (i = 0; i < (int)chunk_payload_padding; i++) {
-            PutBits(stream, 0, 8);
-        }
-        
+        // Pad the remainder of the chunk payload with zeros in one call
+        PutBits(stream, 0, (BITCOUNT)(chunk_payload_padding * 8));
+
+
         // Check that the bitstream is aligned on a segment boundary
         assert(IsAlignedSegment(stream));
         if (! (IsAlignedSegment(stream))) {
@@ -45,12 +45,10 @@
  */
 static CODEC_ERROR AlignBitsByte(BITSTREAM *bitstream)
 {
-    if (bitstream->count > 0 && (bitstream->count % 8) != 0)
-    {
-        // Compute the number of bits of padding
-        BITCOUNT count = (8 - (bitstream->count % 8));
-        PutBits(bitstream, 0, count);
-    }
+    // Compute the number of bits of padding (zero when already aligned,
+    // which PutBits handles without touching the bitstream)
+    BITCOUNT count = (BITCOUNT)(-bitstream->count) & 0x07;
+    PutBits(bitstream, 0, count);
     assert((bitstream->count % 8) == 0);
     return CODEC_ERROR_OKAY;
 }
@@ -78,12 +76,13 @@ static CODEC_ERROR AlignBitsSegment(BITSTREAM *bitstream)
     // Add the number of bytes written to the stream
     byte_count += stream->byte_count;
     
-    while ((byte_count % sizeof(TAGVALUE)) != 0)
+    // Write all of the padding bytes with a single call
     {
-        PutBits(bitstream, 0, 8);
-        byte_count++;
+        size_t padding = (sizeof(TAGVALUE) - (byte_count % sizeof(TAGVALUE))) % sizeof(TAGVALUE);
+        PutBits(bitstream, 0, (BITCOUNT)(padding * 8));
+        byte_count += padding;
     }
-    
+
     // The bitstream should be aligned to the next segment
     assert((bitstream->count == 0) || (bitstream->count == bit_word_count));
     assert((byte_count % sizeof(TAGVALUE)) == 0);
@@ -249,7 +248,7 @@ CODEC_ERROR PrepareEncoderState(ENCODER *encoder,
 	encoder->pattern_height = parameters->pattern_height;
 	encoder->components_per_sample = parameters->components_per_sample;
 	encoder->image_format = parameters->encoded.format;
-    encoder->max_bits_per_component = MaxBitsPerComponent(image);
+    // The maximum number of bits per component was recorded by PrepareEncoder
 
 	// Set default parameters for the image format
 	SetImageFormatDefaults(encoder);
@@ -373,7 +372,7 @@ CODEC_ERROR EncodeImage(IMAGE *image, STREAM *stream, RGB_IMAGE *rgb_image, ENCO
 
         WaveletToRGB(parameters->allocator,
                      encoder.transform[0].wavelet[2]->data[LL_BAND], encoder.transform[1].wavelet[2]->data[LL_BAND], encoder.transform[2].wavelet[2]->data[LL_BAND],
-                     encoder.transform[0].wavelet[2]->width, encoder.transform[0].wavelet[2]->height, encoder.transform[0].wavelet[2]->width,
+                     encoder.transform[0].wavelet[2]->width, encoder.transform[0].wavelet[2]->height, (DIMENSION)(encoder.transform[0].wavelet[2]->pitch / sizeof(PIXEL)),
                      rgb_image, 14, 8, &parameters->rgb_gain );
     }
     
@@ -516,7 +515,12 @@ CODEC_ERROR PrepareEncoder(ENCODER *encoder,
 
 	// Remember the internal precision used by the image unpacking process
     encoder->internal_precision = minimum(max_bits_per_component, default_internal_precision);
-    
+
+    // Record the largest component precision so that the codec state
+    // preparation below does not scan the component arrays again
+    encoder->max_bits_per_component = max_bits_per_component;
+
+
 	// Initialize the encoding parameters and the codec state
 	PrepareEncoderState(encoder, image, parameters);
 
@@ -564,6 +568,9 @@ CODEC_ERROR ReleaseEncoder(ENCODER *encoder)
 			ReleaseTransform(allocator, &encoder->transform[channel]);
 		}
 
+		// Free the band data allocations parked for reuse
+		FlushWaveletPool();
+
 		//TODO: Free the encoding buffers
 	}
 
@@ -2338,7 +2345,6 @@ CODEC_ERROR EncodeHighpassBandRowRuns(BITSTREAM *stream, ENCODER_CODESET *codese
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
 
-	int row_padding;
 	int row = 0;
 	//int column = 0;
 	//size_t index = 0;
@@ -2361,9 +2367,6 @@ CODEC_ERROR EncodeHighpassBandRowRuns(BITSTREAM *stream, ENCODER_CODESET *codese
 	// Check that the band dimensions are reasonable
 	assert(width <= pitch);
 
-	// Compute the number of values of padding at the end of each row
-	row_padding = pitch - width;
-
 	VLE *mags_table_entry = (VLE *)((uint8_t *)mags_table + sizeof(MAGS_TABLE));
 
     VLE stream_bits;
@@ -2375,7 +2378,7 @@ CODEC_ERROR EncodeHighpassBandRowRuns(BITSTREAM *stream, ENCODER_CODESET *codese
     
     int mags_table_length_minus_1 = mags_table->length - 1;
     
-    uint8_t* stream_buffer      = (uint8_t *)bit_stream->location.memory.buffer + bit_stream->byte_count;
+    uint8_t* stream_buffer      = bit_stream->cur;
     uint8_t* stream_buffer_orig = stream_buffer;
     
 	uint32_t count = 0;
@@ -2441,10 +2444,11 @@ CODEC_ERROR EncodeHighpassBandRowRuns(BITSTREAM *stream, ENCODER_CODESET *codese
 				}
 			}
 
-			// Add the end of row padding to the encoded length
+			// The encoded band contains exactly width * height values: the
+			// decoder inserts the end of row padding itself, so the padding
+			// must not be folded into the encoded run lengths
 			if (index == width)
             {
-                count += row_padding;
                 break;
             }
 		}
@@ -2458,6 +2462,7 @@ CODEC_ERROR EncodeHighpassBandRowRuns(BITSTREAM *stream, ENCODER_CODESET *codese
 
 	stream->count = stream_bits.size;
 	stream->buffer = stream_bits.bits;
+    bit_stream->cur = stream_buffer;
     bit_stream->byte_count += (stream_buffer - stream_buffer_orig);
     
 	// // Need to output a pending run of zeros?
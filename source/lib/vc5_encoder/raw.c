@@ -22,6 +22,115 @@
 #include <arm_neon.h>
 #endif
 
+#if VC5_HAVE_AVX2
+
+#include <immintrin.h>
+
+/*!
+	@brief Narrow eight 32-bit lanes to packed 16-bit values
+
+	The lanes must already be clamped to the unsigned 16-bit range.
+*/
+VC5_TARGET_AVX2
+STATIC_INLINE __m128i PackLowWords_AVX2(__m256i v)
+{
+    v = _mm256_packus_epi32(v, v);
+    v = _mm256_permute4x64_epi64(v, 0x08);
+    return _mm256_castsi256_si128(v);
+}
+
+/*!
+	@brief Unpack one row of Bayer pattern elements into the component rows using AVX2
+
+	Eight columns of the two input half rows are deinterleaved into the
+	Bayer primaries as 32-bit lanes, mapped through the log curve table
+	with vector gathers and converted to the difference components with
+	the same arithmetic as the scalar loop in @ref UnpackPixel_12, so the
+	results are identical including the final clamp.  The prescale shift
+	positions the input samples for the table index (two for 14-bit
+	input, zero for 12-bit input) and the format choice is a flag hoisted
+	out of the column loop.  The remainder of the row is handled by the
+	scalar loop.
+
+	@return The number of columns unpacked (a multiple of eight).
+*/
+VC5_TARGET_AVX2
+static int UnpackBayerComponentsRow_AVX2(const uint16_t *input_row1_ptr, const uint16_t *input_row2_ptr,
+                                         PIXEL *output_buffer[], int width, int prescale_shift, bool rggb)
+{
+    const __m256i zero_epi32 = _mm256_setzero_si256();
+    const __m256i max12_epi32 = _mm256_set1_epi32((1 << 12) - 1);
+    const __m256i mask16_epi32 = _mm256_set1_epi32(0xFFFF);
+    const __m256i midpoint_x2_epi32 = _mm256_set1_epi32(2 * (1 << 11));
+    const __m128i shift_count = _mm_cvtsi32_si128(prescale_shift);
+
+    const int vector_width = width & ~7;
+    int column;
+
+    for (column = 0; column < vector_width; column += 8)
+    {
+        __m256i R1, G1, G2, B1;
+        __m256i GS, GD, RG, BG;
+
+        // Load eight pattern elements from each half row and split the
+        // interleaved primaries into separate vectors of 32-bit lanes
+        __m256i row1 = _mm256_loadu_si256((const __m256i *)(input_row1_ptr + 2 * column));
+        __m256i row2 = _mm256_loadu_si256((const __m256i *)(input_row2_ptr + 2 * column));
+
+        __m256i row1_even = _mm256_and_si256(row1, mask16_epi32);
+        __m256i row1_odd  = _mm256_srli_epi32(row1, 16);
+        __m256i row2_even = _mm256_and_si256(row2, mask16_epi32);
+        __m256i row2_odd  = _mm256_srli_epi32(row2, 16);
+
+        if (rggb)
+        {
+            R1 = row1_even;
+            G1 = row1_odd;
+            G2 = row2_even;
+            B1 = row2_odd;
+        }
+        else
+        {
+            G1 = row1_even;
+            B1 = row1_odd;
+            R1 = row2_even;
+            G2 = row2_odd;
+        }
+
+        // Apply the protune log curve with vector gathers
+        R1 = _mm256_srl_epi32(R1, shift_count);
+        G1 = _mm256_srl_epi32(G1, shift_count);
+        G2 = _mm256_srl_epi32(G2, shift_count);
+        B1 = _mm256_srl_epi32(B1, shift_count);
+
+        R1 = _mm256_and_si256(_mm256_i32gather_epi32((const int *)EncoderLogCurve, R1, 2), mask16_epi32);
+        G1 = _mm256_and_si256(_mm256_i32gather_epi32((const int *)EncoderLogCurve, G1, 2), mask16_epi32);
+        G2 = _mm256_and_si256(_mm256_i32gather_epi32((const int *)EncoderLogCurve, G2, 2), mask16_epi32);
+        B1 = _mm256_and_si256(_mm256_i32gather_epi32((const int *)EncoderLogCurve, B1, 2), mask16_epi32);
+
+        // Difference the green components and subtract green from the red and blue components
+        GS = _mm256_srli_epi32(_mm256_add_epi32(G1, G2), 1);
+        GD = _mm256_srli_epi32(_mm256_add_epi32(_mm256_sub_epi32(G1, G2), midpoint_x2_epi32), 1);
+        RG = _mm256_srli_epi32(_mm256_add_epi32(_mm256_sub_epi32(R1, GS), midpoint_x2_epi32), 1);
+        BG = _mm256_srli_epi32(_mm256_add_epi32(_mm256_sub_epi32(B1, GS), midpoint_x2_epi32), 1);
+
+        // Clamp the components to 12 bits like the scalar loop
+        GS = _mm256_min_epi32(_mm256_max_epi32(GS, zero_epi32), max12_epi32);
+        GD = _mm256_min_epi32(_mm256_max_epi32(GD, zero_epi32), max12_epi32);
+        RG = _mm256_min_epi32(_mm256_max_epi32(RG, zero_epi32), max12_epi32);
+        BG = _mm256_min_epi32(_mm256_max_epi32(BG, zero_epi32), max12_epi32);
+
+        _mm_storeu_si128((__m128i *)((uint16_t *)output_buffer[0] + column), PackLowWords_AVX2(GS));
+        _mm_storeu_si128((__m128i *)((uint16_t *)output_buffer[1] + column), PackLowWords_AVX2(RG));
+        _mm_storeu_si128((__m128i *)((uint16_t *)output_buffer[2] + column), PackLowWords_AVX2(BG));
+        _mm_storeu_si128((__m128i *)((uint16_t *)output_buffer[3] + column), PackLowWords_AVX2(GD));
+    }
+
+    return vector_width;
+}
+
+#endif // VC5_HAVE_AVX2
+
 /** ------------------- **/
 /** 14 BIT INPUT FORMAT **/
 /** ------------------- **/
@@ -184,7 +293,16 @@ void UnpackImage_14(const PACKED_IMAGE *input, UNPACKED_IMAGE *output, ENABLED_P
         uint16_t* input_row2_ptr = input_row_ptr + (input_pitch / sizeof(uint16_t));
         
         int column = 0;
-        
+
+#if VC5_HAVE_AVX2
+        // Unpack as much of the row as possible eight columns at a time
+        if (CpuHasAVX2())
+        {
+            column = UnpackBayerComponentsRow_AVX2(input_row_ptr, input_row2_ptr, output_row_ptr_array,
+                                                   input_width, 2, rggb);
+        }
+#endif
+
         // Unpack the row of Bayer components from the BYR4 pattern elements
         for (; column < input_width_m8; column+= 8)
         {
@@ -367,7 +485,16 @@ void UnpackImage_12(const PACKED_IMAGE *input, UNPACKED_IMAGE *output, ENABLED_P
         uint16_t* input_row2_ptr = input_row_ptr + (input_pitch / sizeof(uint16_t));
         
         int column = 0;
-        
+
+#if VC5_HAVE_AVX2
+        // Unpack as much of the row as possible eight columns at a time
+        if (CpuHasAVX2())
+        {
+            column = UnpackBayerComponentsRow_AVX2(input_row_ptr, input_row2_ptr, output_row_ptr_array,
+                                                   input_width, 0, rggb);
+        }
+#endif
+
         // Unpack the row of Bayer components from the BYR4 pattern elements
         for (; column < input_width_m8; column+= 8)
         {
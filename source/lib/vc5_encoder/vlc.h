@@ -116,11 +116,17 @@ typedef struct _runs_table
 
 /*!
 	@brief Entry in the table for encoding runs of zeros
+
+	The fields are sized to the actual ranges in the derived table (a
+	composite codeword fits in one bit word and the run covered by an
+	entry is bounded by the table length) so each entry occupies 8 bytes
+	and the whole table stays resident in fewer cache lines during the
+	encoding loop.
 */
 typedef struct _rlc {	// Codebook entries for runs of zeros
-	uint_fast8_t size;		//!< Size of code word in bits
-	uint32_t count;			//!< Remaining length of the run
 	uint32_t bits;			//!< Code word bits (right justified)
+	uint16_t count;			//!< Remaining length of the run
+	uint8_t size;			//!< Size of code word in bits
 } RLC;
 
 